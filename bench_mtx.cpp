@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "cktso-gpu-host.h"
+
+//reader of the demos (see demo.cpp), entries sorted by column
+bool ReadMtxFile(const char file[], int &n, int *&ap, int *&ai, double *&ax)
+{
+    FILE *fp = fopen(file, "r");
+    if (NULL == fp)
+    {
+        printf("Cannot open file \"%s\".\n", file);
+        return false;
+    }
+
+    char buf[256] = "\0";
+    bool first = true;
+    int pc = 0;
+    int ptr = 0;
+    while (fgets(buf, 256, fp) != NULL)
+    {
+        const char *p = buf;
+        while (*p != '\0')
+        {
+            if (' ' == *p || '\t' == *p || '\r' == *p || '\n' == *p) ++p;
+            else break;
+        }
+
+        if (*p == '\0') continue;
+        else if (*p == '%') continue;
+        else
+        {
+            if (first)
+            {
+                first = false;
+                int r, c, nz;
+                sscanf(p, "%d %d %d", &r, &c, &nz);
+                if (r != c)
+                {
+                    printf("Matrix is not square because row = %d and column = %d.\n", r, c);
+                    fclose(fp);
+                    return false;
+                }
+
+                n = r;
+                ap = new int [n + 1];
+                ai = new int [nz];
+                ax = new double [nz];
+                if (NULL == ap || NULL == ai || NULL == ax)
+                {
+                    printf("Malloc for matrix failed.\n");
+                    fclose(fp);
+                    return false;
+                }
+                ap[0] = 0;
+            }
+            else
+            {
+                int r, c;
+                double v;
+                sscanf(p, "%d %d %lf", &r, &c, &v);
+                --r;
+                --c;
+                ai[ptr] = r;
+                ax[ptr] = v;
+                if (c != pc)
+                {
+                    ap[c] = ptr;
+                    pc = c;
+                }
+                ++ptr;
+            }
+        }
+    }
+    ap[n] = ptr;
+
+    fclose(fp);
+    return true;
+}
+
+static double Seconds(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        printf("Usage: bench_mtx <mtx file> [repeats] [threads]\n");
+        printf("Example: bench_mtx add20.mtx 10 0\n");
+        return -1;
+    }
+    const int repeats = argc > 2 ? atoi(argv[2]) : 10;
+    const int threads = argc > 3 ? atoi(argv[3]) : 0;
+
+    int n = 0, nnz = 0;
+    double t_demo = 0.;
+    for (int k = 0; k < repeats; ++k)
+    {
+        int *ap = NULL;
+        int *ai = NULL;
+        double *ax = NULL;
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        const bool ok = ReadMtxFile(argv[1], n, ap, ai, ax);
+        t_demo += Seconds(t0);
+        if (ok) nnz = ap[n];
+        delete []ap;
+        delete []ai;
+        delete []ax;
+        if (!ok) return -1;
+    }
+
+    double t_lib[2] = {0., 0.};
+    const int lib_threads[2] = {1, threads};
+    for (int t = 0; t < 2; ++t)
+    {
+        for (int k = 0; k < repeats; ++k)
+        {
+            int m, *ap, *ai;
+            double *ax;
+            bool is_complex;
+            std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+            const int ret = CKTSO_ReadMatrixMarket(argv[1], &m, &ap, &ai, &ax, &is_complex, false, lib_threads[t]);
+            t_lib[t] += Seconds(t0);
+            if (ret != 0)
+            {
+                printf("CKTSO_ReadMatrixMarket failed, return code = %d.\n", ret);
+                return -1;
+            }
+            CKTSO_FreeMatrix(ap, ai, ax);
+        }
+    }
+
+    printf("n = %d, nnz = %d.\n", n, nnz);
+    printf("%-24s %12s %9s\n", "loader", "time (s)", "speedup");
+    printf("%-24s %12g %9.2f\n", "demo (fgets + sscanf)", t_demo / repeats, 1.);
+    printf("%-24s %12g %9.2f\n", "library, 1 thread", t_lib[0] / repeats, t_demo / t_lib[0]);
+    printf("%-24s %12g %9.2f\n", "library, all threads", t_lib[1] / repeats, t_demo / t_lib[1]);
+    return 0;
+}
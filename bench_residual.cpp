@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <complex>
+#include "cktso-gpu-host.h"
+
+typedef std::complex<double> complex;
+
+bool ReadMtxFile(const char file[], int &n, int *&ap, int *&ai, double *&ax)
+{
+    FILE *fp = fopen(file, "r");
+    if (NULL == fp)
+    {
+        printf("Cannot open file \"%s\".\n", file);
+        return false;
+    }
+
+    char buf[256] = "\0";
+    bool first = true;
+    int pc = 0;
+    int ptr = 0;
+    while (fgets(buf, 256, fp) != NULL)
+    {
+        const char *p = buf;
+        while (*p != '\0')
+        {
+            if (' ' == *p || '\t' == *p || '\r' == *p || '\n' == *p) ++p;
+            else break;
+        }
+
+        if (*p == '\0') continue;
+        else if (*p == '%') continue;
+        else
+        {
+            if (first)
+            {
+                first = false;
+                int r, c, nz;
+                sscanf(p, "%d %d %d", &r, &c, &nz);
+                if (r != c)
+                {
+                    printf("Matrix is not square because row = %d and column = %d.\n", r, c);
+                    fclose(fp);
+                    return false;
+                }
+
+                n = r;
+                ap = new int [n + 1];
+                ai = new int [nz];
+                ax = new double [nz];
+                if (NULL == ap || NULL == ai || NULL == ax)
+                {
+                    printf("Malloc for matrix failed.\n");
+                    fclose(fp);
+                    return false;
+                }
+                ap[0] = 0;
+            }
+            else
+            {
+                int r, c;
+                double v;
+                sscanf(p, "%d %d %lf", &r, &c, &v);
+                --r;
+                --c;
+                ai[ptr] = r;
+                ax[ptr] = v;
+                if (c != pc)
+                {
+                    ap[c] = ptr;
+                    pc = c;
+                }
+                ++ptr;
+            }
+        }
+    }
+    ap[n] = ptr;
+
+    fclose(fp);
+    return true;
+}
+
+//residual as computed by the demos (see demo.cpp and demo_c.cpp)
+template <typename T>
+double L2NormOfResidual(const int n, const int ap[], const int ai[], const T ax[], const T x[], const T b[], bool row0_col1)
+{
+    if (row0_col1)
+    {
+        T *bb = new T [n];
+        memcpy(bb, b, sizeof(T) * n);
+        for (int i = 0; i < n; ++i)
+        {
+            const T xx = x[i];
+            const int start = ap[i];
+            const int end = ap[i + 1];
+            for (int p = start; p < end; ++p)
+            {
+                bb[ai[p]] -= xx * ax[p];
+            }
+        }
+        double s = 0.;
+        for (int i = 0; i < n; ++i)
+        {
+            s += std::norm(bb[i]);
+        }
+        delete []bb;
+        return sqrt(s);
+    }
+    else
+    {
+        double s = 0.;
+        for (int i = 0; i < n; ++i)
+        {
+            T r = 0.;
+            const int start = ap[i];
+            const int end = ap[i + 1];
+            for (int p = start; p < end; ++p)
+            {
+                const int j = ai[p];
+                r += ax[p] * x[j];
+            }
+            r -= b[i];
+            s += std::norm(r);
+        }
+        return sqrt(s);
+    }
+}
+
+static double Seconds(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        printf("Usage: bench_residual <mtx file> [repeats] [threads]\n");
+        printf("Example: bench_residual add20.mtx 100 0\n");
+        return -1;
+    }
+
+    int n;
+    int *ap = NULL;
+    int *ai = NULL;
+    double *ax = NULL;
+    if (!ReadMtxFile(argv[1], n, ap, ai, ax)) return -1;
+    const int repeats = argc > 2 ? atoi(argv[2]) : 100;
+    const int threads = argc > 3 ? atoi(argv[3]) : 0;
+    const int nnz = ap[n];
+
+    //complex data: real part from the matrix, random imaginary part
+    double *cx = new double [nnz * 2];
+    double *b = new double [n * 2];
+    double *x = new double [n * 2];
+    for (int i = 0; i < nnz; ++i)
+    {
+        cx[2 * i] = ax[i];
+        cx[2 * i + 1] = ax[i] * ((double)rand() / RAND_MAX - .5);
+    }
+    for (int i = 0; i < 2 * n; ++i)
+    {
+        b[i] = (double)rand() / RAND_MAX * 100.;
+        x[i] = (double)rand() / RAND_MAX;
+    }
+
+    printf("%-8s %-7s %14s %14s %9s %12s\n", "data", "mode", "demo (s)", "library (s)", "speedup", "rel. diff");
+    for (int cplx = 0; cplx < 2; ++cplx)
+    {
+        const double *a = cplx ? cx : ax;
+        for (int mode = 0; mode < 2; ++mode)
+        {
+            double ref = 0., norms[3];
+            std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+            for (int k = 0; k < repeats; ++k)
+            {
+                if (cplx) ref = L2NormOfResidual(n, ap, ai, (const complex *)a, (const complex *)x, (const complex *)b, mode != 0);
+                else ref = L2NormOfResidual(n, ap, ai, a, x, b, mode != 0);
+            }
+            const double t_demo = Seconds(t0);
+
+            int ret = 0;
+            t0 = std::chrono::steady_clock::now();
+            for (int k = 0; k < repeats; ++k)
+            {
+                ret |= CKTSO_Residual(cplx != 0, n, ap, ai, a, x, b, NULL, norms, mode != 0, threads);
+            }
+            const double t_lib = Seconds(t0);
+            if (ret != 0)
+            {
+                printf("CKTSO_Residual failed, return code = %d.\n", ret);
+                break;
+            }
+
+            printf("%-8s %-7s %14g %14g %9.2f %12.3g\n", cplx ? "complex" : "real", mode ? "column" : "row",
+                t_demo / repeats, t_lib / repeats, t_demo / t_lib, fabs(norms[1] - ref) / ref);
+        }
+    }
+
+    delete []ap;
+    delete []ai;
+    delete []ax;
+    delete []cx;
+    delete []b;
+    delete []x;
+    return 0;
+}
@@ -0,0 +1,586 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+#include "cktso-gpu-host.h"
+#include "cktso-bin.h"
+
+//refactor and solve benchmark over a matrix corpus, see Usage() for options
+
+struct Options
+{
+    int warmup;
+    int iters;
+    int gpuid;
+    bool index32, index64;
+    bool real, complex;
+    bool split;
+    const char *json;
+    const char *csv;
+    const char *baseline;
+    double threshold;
+};
+
+struct Stats
+{
+    double median, p95, p99; //in microseconds
+};
+
+struct Result
+{
+    std::string matrix, index, value, mode, backend;
+    long long n, nnz;
+    int ret;
+    Stats refactor, solve;
+    double refactor_gflops, solve_gflops; //<0 when the accelerator does not report its factors
+    long long host_mem, factor_mem;
+};
+
+//matrix as loaded, long long indexes, CSC of the file (the layout read by the demos)
+struct Matrix
+{
+    std::string name;
+    long long n;
+    std::vector<long long> ap, ai;
+    std::vector<double> ax;
+    bool is_complex;
+};
+
+static void Usage()
+{
+    printf("Usage: bench_suite [options] <mtx or binary files, or directories>\n");
+    printf("  -w <n>     warmup iterations [3]\n");
+    printf("  -n <n>     timed iterations [20]\n");
+    printf("  -g <id>    gpu id, -1 for host accelerator [-1]\n");
+    printf("  -i 32|64   int or long long indexes only [both]\n");
+    printf("  -v r|c     real or complex values only [both, complex values are made from a real matrix]\n");
+    printf("  -s         also runs complex values with separate real and imaginary arrays (value \"split\", host accelerator only)\n");
+    printf("  -j <file>  JSON output\n");
+    printf("  -c <file>  CSV output\n");
+    printf("  -b <file>  baseline CSV (written by -c) to compare median latencies with\n");
+    printf("  -t <pct>   regression threshold in percent [10]\n");
+    printf("Example: bench_suite -n 50 -c base.csv matrices/\n");
+    printf("Returns 1 when a regression is found against the baseline.\n");
+}
+
+static bool EndsWith(const std::string &s, const char *suffix)
+{
+    const size_t len = strlen(suffix);
+    return s.size() >= len && s.compare(s.size() - len, len, suffix) == 0;
+}
+
+static bool IsMatrixFile(const std::string &file)
+{
+    return EndsWith(file, ".mtx") || CKTSO_IsBinaryMatrix(file.c_str());
+}
+
+//files are taken as given, directories are scanned (not recursively) for .mtx files and binary containers
+static void Collect(const char path[], std::vector<std::string> &files)
+{
+    std::vector<std::string> found;
+#ifdef _WIN32
+    const DWORD attr = GetFileAttributesA(path);
+    if (attr != INVALID_FILE_ATTRIBUTES && (attr & FILE_ATTRIBUTE_DIRECTORY))
+    {
+        WIN32_FIND_DATAA fd;
+        HANDLE h = FindFirstFileA((std::string(path) + "\\*").c_str(), &fd);
+        if (h != INVALID_HANDLE_VALUE)
+        {
+            do
+            {
+                if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+                const std::string file = std::string(path) + "\\" + fd.cFileName;
+                if (IsMatrixFile(file)) found.push_back(file);
+            } while (FindNextFileA(h, &fd));
+            FindClose(h);
+        }
+    }
+    else found.push_back(path);
+#else
+    struct stat st;
+    DIR *dir = (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) ? opendir(path) : NULL;
+    if (dir != NULL)
+    {
+        struct dirent *e;
+        while ((e = readdir(dir)) != NULL)
+        {
+            const std::string file = std::string(path) + "/" + e->d_name;
+            if (stat(file.c_str(), &st) == 0 && S_ISREG(st.st_mode) && IsMatrixFile(file)) found.push_back(file);
+        }
+        closedir(dir);
+    }
+    else found.push_back(path);
+#endif
+    std::sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+}
+
+static bool Load(const std::string &file, Matrix &m)
+{
+    const size_t slash = file.find_last_of("/\\");
+    m.name = slash == std::string::npos ? file : file.substr(slash + 1);
+    if (CKTSO_IsBinaryMatrix(file.c_str()))
+    {
+        CKTSO_BIN_MATRIX bin;
+        const int ret = CKTSO_MapBinaryMatrix(file.c_str(), &bin);
+        if (ret != 0 || (bin.header.flags & CKTSO_BIN_CSR))
+        {
+            printf("Cannot use binary file \"%s\" (return code = %d, CSR containers are not supported).\n", file.c_str(), ret);
+            if (0 == ret) CKTSO_UnmapBinaryMatrix(&bin);
+            return false;
+        }
+        m.n = bin.header.n;
+        m.is_complex = (bin.header.flags & CKTSO_BIN_COMPLEX) != 0;
+        const long long nnz = bin.header.nnz;
+        if (bin.header.flags & CKTSO_BIN_INDEX64)
+        {
+            m.ap.assign((const long long *)bin.ap, (const long long *)bin.ap + m.n + 1);
+            m.ai.assign((const long long *)bin.ai, (const long long *)bin.ai + nnz);
+        }
+        else
+        {
+            m.ap.assign((const int *)bin.ap, (const int *)bin.ap + m.n + 1);
+            m.ai.assign((const int *)bin.ai, (const int *)bin.ai + nnz);
+        }
+        m.ax.assign(bin.ax, bin.ax + nnz * (m.is_complex ? 2 : 1));
+        CKTSO_UnmapBinaryMatrix(&bin);
+        return true;
+    }
+
+    long long *ap = NULL, *ai = NULL;
+    double *ax = NULL;
+    const int ret = CKTSO_L_ReadMatrixMarket(file.c_str(), &m.n, &ap, &ai, &ax, &m.is_complex, false, 0);
+    if (ret != 0)
+    {
+        printf("Cannot read \"%s\", return code = %d.\n", file.c_str(), ret);
+        return false;
+    }
+    m.ap.assign(ap, ap + m.n + 1);
+    m.ai.assign(ai, ai + ap[m.n]);
+    m.ax.assign(ax, ax + ap[m.n] * (m.is_complex ? 2 : 1));
+    CKTSO_FreeMatrix(ap, ai, ax);
+    return true;
+}
+
+//nearest-rank percentiles
+static Stats Summarize(std::vector<double> &t)
+{
+    Stats s = { 0., 0., 0. };
+    if (t.empty()) return s;
+    std::sort(t.begin(), t.end());
+    const size_t n = t.size();
+    s.median = (n & 1) ? t[n / 2] : .5 * (t[n / 2 - 1] + t[n / 2]);
+    s.p95 = t[std::min(n - 1, (size_t)ceil(.95 * n) - 1)];
+    s.p99 = t[std::min(n - 1, (size_t)ceil(.99 * n) - 1)];
+    return s;
+}
+
+template <typename F>
+static double Microseconds(F f, int &ret)
+{
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    ret = f();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+}
+
+//interfaces of one index width
+struct Int32
+{
+    typedef int Index;
+    typedef ICktSo Solver;
+    typedef ICktSoGpu Accel;
+    static const char *Name()
+    {
+        return "int";
+    }
+    static int CreateSolver(Solver *s, int **iparm, const long long **oparm)
+    {
+        return CKTSO_CreateSolver(s, iparm, oparm);
+    }
+    static int CreateAccelerator(Accel *a, int **iparm, const long long **oparm, int gpuid)
+    {
+        return CKTSO_CreateAccelerator(a, iparm, oparm, gpuid);
+    }
+    static int SetHostMatrix(Accel a, bool is_complex, Index n, const Index ap[], const Index ai[], const double ax[])
+    {
+        return CKTSO_SetHostMatrix(a, is_complex, n, ap, ai, ax);
+    }
+    static bool IsHost(Accel a)
+    {
+        return CKTSO_IsHostAccelerator(a);
+    }
+    static int RefactorizeSplit(Accel a, const double re[], const double im[])
+    {
+        return CKTSO_GpuRefactorizeSplit(a, re, im);
+    }
+    static int SolveSplit(Accel a, const double bre[], const double bim[], double xre[], double xim[], bool row0_column1)
+    {
+        return CKTSO_GpuSolveSplit(a, bre, bim, xre, xim, row0_column1);
+    }
+};
+
+struct Int64
+{
+    typedef long long Index;
+    typedef ICktSo_L Solver;
+    typedef ICktSoGpu_L Accel;
+    static const char *Name()
+    {
+        return "long long";
+    }
+    static int CreateSolver(Solver *s, int **iparm, const long long **oparm)
+    {
+        return CKTSO_L_CreateSolver(s, iparm, oparm);
+    }
+    static int CreateAccelerator(Accel *a, int **iparm, const long long **oparm, int gpuid)
+    {
+        return CKTSO_L_CreateAccelerator(a, iparm, oparm, gpuid);
+    }
+    static int SetHostMatrix(Accel a, bool is_complex, Index n, const Index ap[], const Index ai[], const double ax[])
+    {
+        return CKTSO_L_SetHostMatrix(a, is_complex, n, ap, ai, ax);
+    }
+    static bool IsHost(Accel a)
+    {
+        return CKTSO_L_IsHostAccelerator(a);
+    }
+    static int RefactorizeSplit(Accel a, const double re[], const double im[])
+    {
+        return CKTSO_L_GpuRefactorizeSplit(a, re, im);
+    }
+    static int SolveSplit(Accel a, const double bre[], const double bim[], double xre[], double xim[], bool row0_column1)
+    {
+        return CKTSO_L_GpuSolveSplit(a, bre, bim, xre, xim, row0_column1);
+    }
+};
+
+//one index width and value type, both solve modes, appends 2 results
+//split: complex values, b and x are passed as separate real and imaginary arrays
+template <typename W>
+static void Run(const Matrix &m, bool is_complex, bool split, const Options &opt, std::vector<Result> &results)
+{
+    typedef typename W::Index Index;
+    const Index n = (Index)m.n;
+    std::vector<Index> ap(m.ap.begin(), m.ap.end());
+    std::vector<Index> ai(m.ai.begin(), m.ai.end());
+    const size_t nnz = m.ai.size();
+
+    //complex values of a real matrix: real part from the matrix, random imaginary part
+    std::vector<double> ax;
+    if (is_complex == m.is_complex) ax = m.ax;
+    else
+    {
+        ax.resize(2 * nnz);
+        for (size_t i = 0; i < nnz; ++i)
+        {
+            ax[2 * i] = m.ax[i];
+            ax[2 * i + 1] = m.ax[i] * ((double)rand() / RAND_MAX - .5);
+        }
+    }
+    const size_t scalar = is_complex ? 2 : 1;
+    std::vector<double> b(n * scalar), x(n * scalar);
+    for (size_t i = 0; i < b.size(); ++i) b[i] = (double)rand() / RAND_MAX * 100.;
+    std::vector<double> re, im, bre, bim, xre, xim;
+    if (split)
+    {
+        re.resize(nnz);
+        im.resize(nnz);
+        for (size_t i = 0; i < nnz; ++i)
+        {
+            re[i] = ax[2 * i];
+            im[i] = ax[2 * i + 1];
+        }
+        bre.resize(n);
+        bim.resize(n);
+        xre.resize(n);
+        xim.resize(n);
+        for (Index i = 0; i < n; ++i)
+        {
+            bre[i] = b[2 * i];
+            bim[i] = b[2 * i + 1];
+        }
+    }
+
+    Result r;
+    r.matrix = m.name;
+    r.index = W::Name();
+    r.value = split ? "split" : is_complex ? "complex" : "real";
+    r.backend = "gpu";
+    r.n = m.n;
+    r.nnz = (long long)nnz;
+    r.ret = 0;
+    r.refactor.median = r.refactor.p95 = r.refactor.p99 = 0.;
+    r.solve = r.refactor;
+    r.refactor_gflops = r.solve_gflops = -1.;
+    r.host_mem = r.factor_mem = 0;
+
+    typename W::Solver inst = NULL;
+    typename W::Accel accel = NULL;
+    int *iparm_cpu, *iparm;
+    const long long *oparm_cpu, *oparm;
+    std::vector<double> tr, ts[2];
+    auto refactorize = [&]() { return split ? W::RefactorizeSplit(accel, &re[0], &im[0]) : accel->GpuRefactorize(&ax[0]); };
+    auto solve = [&](bool row0_column1)
+    {
+        return split ? W::SolveSplit(accel, &bre[0], &bim[0], &xre[0], &xim[0], row0_column1) : accel->GpuSolve(&b[0], &x[0], row0_column1);
+    };
+    int ret = W::CreateSolver(&inst, &iparm_cpu, &oparm_cpu);
+    if (0 == ret) ret = inst->Analyze(is_complex, n, &ap[0], &ai[0], &ax[0], 0);
+    if (0 == ret) ret = inst->Factorize(&ax[0], true);
+    if (0 == ret) ret = inst->SortFactors(true);
+    if (0 == ret) ret = W::CreateAccelerator(&accel, &iparm, &oparm, opt.gpuid);
+    if (0 == ret) ret = W::SetHostMatrix(accel, is_complex, n, &ap[0], &ai[0], &ax[0]);
+    if (0 == ret) ret = accel->InitializeGpuAccelerator(inst);
+    for (int k = 0; k < opt.warmup && 0 == ret; ++k)
+    {
+        ret = refactorize();
+        if (0 == ret) ret = solve(false);
+    }
+    for (int k = 0; k < opt.iters && 0 == ret; ++k)
+    {
+        tr.push_back(Microseconds(refactorize, ret));
+    }
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        for (int k = 0; k < opt.iters && 0 == ret; ++k)
+        {
+            ts[mode].push_back(Microseconds([&]() { return solve(mode != 0); }, ret));
+        }
+    }
+
+    r.ret = ret;
+    if (0 == ret)
+    {
+        r.refactor = Summarize(tr);
+        r.host_mem = oparm[3];
+        r.factor_mem = oparm[4];
+        if (W::IsHost(accel))
+        {
+            r.backend = "host";
+            r.refactor_gflops = (double)oparm[18] / r.refactor.median * 1e-3;
+        }
+    }
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        r.mode = mode ? "column" : "row";
+        if (0 == ret)
+        {
+            r.solve = Summarize(ts[mode]);
+            //a multiply-add per factor entry, complex ones counting as 4
+            if (r.backend == "host") r.solve_gflops = 2. * (double)oparm[7] * (is_complex ? 4. : 1.) / r.solve.median * 1e-3;
+        }
+        results.push_back(r);
+    }
+
+    if (accel != NULL) accel->DestroyGpuAccelerator();
+    if (inst != NULL) inst->DestroySolver();
+}
+
+static std::string Key(const Result &r)
+{
+    return r.matrix + "," + r.index + "," + r.value + "," + r.mode;
+}
+
+static void Gflops(FILE *fp, double v, bool json)
+{
+    if (v >= 0.) fprintf(fp, "%.4g", v);
+    else if (json) fputs("null", fp);
+}
+
+static bool WriteJson(const char file[], const std::vector<Result> &results, const Options &opt)
+{
+    FILE *fp = fopen(file, "w");
+    if (NULL == fp) return false;
+    fprintf(fp, "{\n  \"warmup\": %d,\n  \"iterations\": %d,\n  \"results\": [\n", opt.warmup, opt.iters);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result &r = results[i];
+        fprintf(fp, "    {\"matrix\": \"%s\", \"n\": %lld, \"nnz\": %lld, \"index\": \"%s\", \"value\": \"%s\", \"mode\": \"%s\", \"backend\": \"%s\", \"ret\": %d,\n",
+            r.matrix.c_str(), r.n, r.nnz, r.index.c_str(), r.value.c_str(), r.mode.c_str(), r.backend.c_str(), r.ret);
+        fprintf(fp, "     \"refactor_us\": {\"median\": %.3f, \"p95\": %.3f, \"p99\": %.3f}, \"refactor_gflops\": ", r.refactor.median, r.refactor.p95, r.refactor.p99);
+        Gflops(fp, r.refactor_gflops, true);
+        fprintf(fp, ",\n     \"solve_us\": {\"median\": %.3f, \"p95\": %.3f, \"p99\": %.3f}, \"solve_gflops\": ", r.solve.median, r.solve.p95, r.solve.p99);
+        Gflops(fp, r.solve_gflops, true);
+        fprintf(fp, ",\n     \"host_mem\": %lld, \"factor_mem\": %lld}%s\n", r.host_mem, r.factor_mem, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    return fclose(fp) == 0;
+}
+
+static const char CSV_HEADER[] = "matrix,index,value,mode,backend,n,nnz,ret,refactor_median_us,refactor_p95_us,refactor_p99_us,refactor_gflops,"
+    "solve_median_us,solve_p95_us,solve_p99_us,solve_gflops,host_mem,factor_mem";
+
+static bool WriteCsv(const char file[], const std::vector<Result> &results)
+{
+    FILE *fp = fopen(file, "w");
+    if (NULL == fp) return false;
+    fprintf(fp, "%s\n", CSV_HEADER);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result &r = results[i];
+        fprintf(fp, "%s,%s,%lld,%lld,%d,%.3f,%.3f,%.3f,", Key(r).c_str(), r.backend.c_str(), r.n, r.nnz, r.ret, r.refactor.median, r.refactor.p95, r.refactor.p99);
+        Gflops(fp, r.refactor_gflops, false);
+        fprintf(fp, ",%.3f,%.3f,%.3f,", r.solve.median, r.solve.p95, r.solve.p99);
+        Gflops(fp, r.solve_gflops, false);
+        fprintf(fp, ",%lld,%lld\n", r.host_mem, r.factor_mem);
+    }
+    return fclose(fp) == 0;
+}
+
+//compares median latencies with a baseline CSV, returns #regressions, or -1 when the baseline cannot be read
+static int Compare(const char file[], const std::vector<Result> &results, double threshold)
+{
+    FILE *fp = fopen(file, "r");
+    if (NULL == fp) return -1;
+    char buf[1024];
+    std::vector<std::string> keys;
+    std::vector<double> refactor, solve;
+    while (fgets(buf, sizeof(buf), fp) != NULL)
+    {
+        //matrix,index,value,mode,backend,n,nnz,ret,refactor median,p95,p99,gflops,solve median
+        std::vector<std::string> f;
+        std::string cell;
+        for (const char *p = buf; *p != '\0' && *p != '\n' && *p != '\r'; ++p)
+        {
+            if (',' == *p)
+            {
+                f.push_back(cell);
+                cell.clear();
+            }
+            else cell += *p;
+        }
+        f.push_back(cell);
+        if (f.size() < 13 || f[0] == "matrix" || atoi(f[7].c_str()) != 0) continue;
+        keys.push_back(f[0] + "," + f[1] + "," + f[2] + "," + f[3]);
+        refactor.push_back(atof(f[8].c_str()));
+        solve.push_back(atof(f[12].c_str()));
+    }
+    fclose(fp);
+
+    int regressions = 0;
+    printf("\n%-24s %-10s %-8s %-7s %12s %12s %12s %12s\n", "matrix", "index", "value", "mode", "refactor", "(change)", "solve", "(change)");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result &r = results[i];
+        const std::vector<std::string>::iterator it = std::find(keys.begin(), keys.end(), Key(r));
+        if (r.ret != 0 || it == keys.end()) continue;
+        const size_t k = it - keys.begin();
+        const double cr = refactor[k] > 0. ? (r.refactor.median / refactor[k] - 1.) * 100. : 0.;
+        const double cs = solve[k] > 0. ? (r.solve.median / solve[k] - 1.) * 100. : 0.;
+        const bool bad = cr > threshold || cs > threshold;
+        if (bad) ++regressions;
+        printf("%-24s %-10s %-8s %-7s %12.1f %+11.1f%% %12.1f %+11.1f%%%s\n", r.matrix.c_str(), r.index.c_str(), r.value.c_str(), r.mode.c_str(),
+            r.refactor.median, cr, r.solve.median, cs, bad ? "  REGRESSION" : "");
+    }
+    return regressions;
+}
+
+int main(int argc, char *argv[])
+{
+    Options opt;
+    opt.warmup = 3;
+    opt.iters = 20;
+    opt.gpuid = -1;
+    opt.index32 = opt.index64 = true;
+    opt.real = opt.complex = true;
+    opt.split = false;
+    opt.json = opt.csv = opt.baseline = NULL;
+    opt.threshold = 10.;
+
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *a = argv[i];
+        const bool has = i + 1 < argc;
+        if (0 == strcmp(a, "-w") && has) opt.warmup = atoi(argv[++i]);
+        else if (0 == strcmp(a, "-n") && has) opt.iters = atoi(argv[++i]);
+        else if (0 == strcmp(a, "-g") && has) opt.gpuid = atoi(argv[++i]);
+        else if (0 == strcmp(a, "-i") && has)
+        {
+            const int bits = atoi(argv[++i]);
+            opt.index32 = (32 == bits);
+            opt.index64 = (64 == bits);
+        }
+        else if (0 == strcmp(a, "-v") && has)
+        {
+            ++i;
+            opt.real = ('r' == argv[i][0]);
+            opt.complex = ('c' == argv[i][0]);
+        }
+        else if (0 == strcmp(a, "-s")) opt.split = true;
+        else if (0 == strcmp(a, "-j") && has) opt.json = argv[++i];
+        else if (0 == strcmp(a, "-c") && has) opt.csv = argv[++i];
+        else if (0 == strcmp(a, "-b") && has) opt.baseline = argv[++i];
+        else if (0 == strcmp(a, "-t") && has) opt.threshold = atof(argv[++i]);
+        else if ('-' == a[0])
+        {
+            Usage();
+            return -1;
+        }
+        else Collect(a, files);
+    }
+    if (files.empty() || opt.iters <= 0)
+    {
+        Usage();
+        return -1;
+    }
+
+    std::vector<Result> results;
+    printf("%-24s %-10s %-8s %-7s %-5s %12s %12s %12s %12s %12s %12s %9s %9s\n", "matrix", "index", "value", "mode", "back",
+        "refactor med", "p95", "p99", "solve med", "p95", "p99", "rf GF/s", "sv GF/s");
+    for (size_t f = 0; f < files.size(); ++f)
+    {
+        Matrix m;
+        if (!Load(files[f], m)) continue;
+        const size_t first = results.size();
+        for (int cplx = 0; cplx < 2; ++cplx)
+        {
+            //a complex file is only benchmarked as complex
+            if ((cplx && !opt.complex) || (!cplx && (!opt.real || m.is_complex))) continue;
+            for (int split = 0; split < (cplx && opt.split ? 2 : 1); ++split)
+            {
+                if (opt.index32 && m.n < INT_MAX && (long long)m.ai.size() < INT_MAX) Run<Int32>(m, cplx != 0, split != 0, opt, results);
+                if (opt.index64) Run<Int64>(m, cplx != 0, split != 0, opt, results);
+            }
+        }
+        for (size_t i = first; i < results.size(); ++i)
+        {
+            const Result &r = results[i];
+            if (r.ret != 0)
+            {
+                printf("%-24s %-10s %-8s %-7s failed, return code = %d\n", r.matrix.c_str(), r.index.c_str(), r.value.c_str(), r.mode.c_str(), r.ret);
+                continue;
+            }
+            printf("%-24s %-10s %-8s %-7s %-5s %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %9.3f %9.3f\n", r.matrix.c_str(), r.index.c_str(), r.value.c_str(),
+                r.mode.c_str(), r.backend.c_str(), r.refactor.median, r.refactor.p95, r.refactor.p99, r.solve.median, r.solve.p95, r.solve.p99,
+                r.refactor_gflops, r.solve_gflops);
+        }
+    }
+    printf("Latencies in microseconds, %d timed iterations after %d warmup iterations.\n", opt.iters, opt.warmup);
+
+    if (opt.json != NULL && !WriteJson(opt.json, results, opt)) printf("Cannot write \"%s\".\n", opt.json);
+    if (opt.csv != NULL && !WriteCsv(opt.csv, results)) printf("Cannot write \"%s\".\n", opt.csv);
+    if (opt.baseline != NULL)
+    {
+        const int regressions = Compare(opt.baseline, results, opt.threshold);
+        if (regressions < 0)
+        {
+            printf("Cannot read baseline \"%s\".\n", opt.baseline);
+            return -1;
+        }
+        printf("%d regression(s) above %g%%.\n", regressions, opt.threshold);
+        if (regressions > 0) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,221 @@
+/*Binary matrix container of CKTSO-GPU demos and tools*/
+/*Header-only, the matrix arrays of a container file are memory-mapped and used in place*/
+#ifndef __CKTSO_BIN__
+#define __CKTSO_BIN__
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include "cktso.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/********** file layout **********
+* little-endian, a 64-byte header followed by ap, ai and ax, each starting at a multiple of 64 bytes (CKTSO_BIN_ALIGN)
+* header:
+*   char magic[8]: "CKTSOBIN"
+*   unsigned int version: CKTSO_BIN_VERSION
+*   unsigned int flags: CKTSO_BIN_INDEX64 (ap, ai are long long, for the _L routines, otherwise int) | CKTSO_BIN_COMPLEX | CKTSO_BIN_CSR
+*   long long n, nnz
+*   unsigned long long offsets of ap (n+1 indexes), ai (nnz indexes) and ax (nnz or 2*nnz doubles) from the beginning of the file
+*   unsigned long long reserved, 0
+* CSC (flag CSR not set) is the layout read by the demos from .mtx files, ap indexed by .mtx column
+********************************/
+
+#define CKTSO_BIN_VERSION   1
+#define CKTSO_BIN_ALIGN     64
+#define CKTSO_BIN_INDEX64   1
+#define CKTSO_BIN_COMPLEX   2
+#define CKTSO_BIN_CSR       4
+
+typedef struct
+{
+	char magic[8];
+	unsigned int version;
+	unsigned int flags;
+	long long n;
+	long long nnz;
+	unsigned long long ap;
+	unsigned long long ai;
+	unsigned long long ax;
+	unsigned long long reserved;
+} CKTSO_BIN_HEADER;
+
+/*
+* CKTSO_BIN_MATRIX: a mapped container file, ap/ai/ax point into the mapping
+* The mapping is private and writable: writes (e.g., changing ax values) stay in memory and are not written to the file
+*/
+typedef struct
+{
+	CKTSO_BIN_HEADER header;
+	void *base;
+	size_t size;
+	void *ap;
+	void *ai;
+	double *ax;
+} CKTSO_BIN_MATRIX;
+
+static inline unsigned long long CKTSO_BinAlign(unsigned long long offset)
+{
+	return (offset + CKTSO_BIN_ALIGN - 1) / CKTSO_BIN_ALIGN * CKTSO_BIN_ALIGN;
+}
+
+/*
+* CKTSO_IsBinaryMatrix: whether the file starts with the container magic
+*/
+static inline bool CKTSO_IsBinaryMatrix
+(
+	_IN_ const char file[]
+)
+{
+	char magic[8];
+	FILE *fp = fopen(file, "rb");
+	if (NULL == fp) return false;
+	const bool ok = fread(magic, 1, 8, fp) == 8 && memcmp(magic, "CKTSOBIN", 8) == 0;
+	fclose(fp);
+	return ok;
+}
+
+/*
+* CKTSO_WriteBinaryMatrix: writes a container file
+* @index64: whether ap and ai are long long arrays, otherwise int arrays
+* @is_complex: whether ax has 2 doubles (real and imaginary parts) per entry
+* @csr: whether ap is indexed by rows
+* @n, ap, ai, ax: matrix
+* returns 0, -2 (argument error) or -56 (file cannot be written)
+*/
+static inline int CKTSO_WriteBinaryMatrix
+(
+	_IN_ const char file[],
+	_IN_ bool index64,
+	_IN_ bool is_complex,
+	_IN_ bool csr,
+	_IN_ long long n,
+	_IN_ const void *ap,
+	_IN_ const void *ai,
+	_IN_ const double ax[]
+)
+{
+	if (NULL == file || n <= 0 || NULL == ap || NULL == ai || NULL == ax) return -2;
+	const size_t isize = index64 ? sizeof(long long) : sizeof(int);
+	const long long nnz = index64 ? ((const long long *)ap)[n] : (long long)((const int *)ap)[n];
+	if (nnz < 0) return -2;
+
+	CKTSO_BIN_HEADER h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, "CKTSOBIN", 8);
+	h.version = CKTSO_BIN_VERSION;
+	h.flags = (index64 ? CKTSO_BIN_INDEX64 : 0) | (is_complex ? CKTSO_BIN_COMPLEX : 0) | (csr ? CKTSO_BIN_CSR : 0);
+	h.n = n;
+	h.nnz = nnz;
+	h.ap = CKTSO_BinAlign(sizeof(h));
+	h.ai = CKTSO_BinAlign(h.ap + isize * (n + 1));
+	h.ax = CKTSO_BinAlign(h.ai + isize * nnz);
+	const unsigned long long end = h.ax + sizeof(double) * (is_complex ? 2 : 1) * nnz;
+
+	FILE *fp = fopen(file, "wb");
+	if (NULL == fp) return -56;
+	static const char zero[CKTSO_BIN_ALIGN] = {0};
+	bool ok = fwrite(&h, sizeof(h), 1, fp) == 1;
+	ok = ok && fwrite(zero, 1, (size_t)(h.ap - sizeof(h)), fp) == (size_t)(h.ap - sizeof(h));
+	ok = ok && fwrite(ap, isize, (size_t)(n + 1), fp) == (size_t)(n + 1);
+	ok = ok && fwrite(zero, 1, (size_t)(h.ai - h.ap - isize * (n + 1)), fp) == (size_t)(h.ai - h.ap - isize * (n + 1));
+	ok = ok && fwrite(ai, isize, (size_t)nnz, fp) == (size_t)nnz;
+	ok = ok && fwrite(zero, 1, (size_t)(h.ax - h.ai - isize * nnz), fp) == (size_t)(h.ax - h.ai - isize * nnz);
+	ok = ok && fwrite(ax, sizeof(double), (size_t)((end - h.ax) / sizeof(double)), fp) == (size_t)((end - h.ax) / sizeof(double));
+	ok = (fclose(fp) == 0) && ok;
+	return ok ? 0 : -56;
+}
+
+/*
+* CKTSO_UnmapBinaryMatrix: releases a mapping made by CKTSO_MapBinaryMatrix
+*/
+static inline void CKTSO_UnmapBinaryMatrix
+(
+	_IN_ CKTSO_BIN_MATRIX *m
+)
+{
+	if (NULL == m || NULL == m->base) return;
+#ifdef _WIN32
+	UnmapViewOfFile(m->base);
+#else
+	munmap(m->base, m->size);
+#endif
+	m->base = NULL;
+	m->ap = m->ai = NULL;
+	m->ax = NULL;
+}
+
+/*
+* CKTSO_MapBinaryMatrix: maps a container file, without reading or copying the arrays
+* returns 0, -3 (invalid or truncated container, or int indexes with n or nnz beyond INT_MAX) or -56 (file cannot be opened or mapped)
+*/
+static inline int CKTSO_MapBinaryMatrix
+(
+	_IN_ const char file[],
+	_OUT_ CKTSO_BIN_MATRIX *m
+)
+{
+	if (NULL == file || NULL == m) return -2;
+	memset(m, 0, sizeof(*m));
+#ifdef _WIN32
+	HANDLE fh = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (INVALID_HANDLE_VALUE == fh) return -56;
+	LARGE_INTEGER fsize;
+	HANDLE mh = GetFileSizeEx(fh, &fsize) ? CreateFileMappingA(fh, NULL, PAGE_WRITECOPY, 0, 0, NULL) : NULL;
+	void *base = NULL == mh ? NULL : MapViewOfFile(mh, FILE_MAP_COPY, 0, 0, 0);
+	if (mh != NULL) CloseHandle(mh);
+	CloseHandle(fh);
+	if (NULL == base) return -56;
+	const size_t size = (size_t)fsize.QuadPart;
+#else
+	const int fd = open(file, O_RDONLY);
+	if (fd < 0) return -56;
+	struct stat st;
+	void *base = MAP_FAILED;
+	if (0 == fstat(fd, &st) && st.st_size > 0) base = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (MAP_FAILED == base) return -56;
+	const size_t size = (size_t)st.st_size;
+#endif
+	m->base = base;
+	m->size = size;
+
+	const CKTSO_BIN_HEADER *h = (const CKTSO_BIN_HEADER *)base;
+	if (size < sizeof(*h) || memcmp(h->magic, "CKTSOBIN", 8) != 0 || h->version != CKTSO_BIN_VERSION || h->n <= 0 || h->nnz < 0
+		|| h->ap % CKTSO_BIN_ALIGN != 0 || h->ai % CKTSO_BIN_ALIGN != 0 || h->ax % CKTSO_BIN_ALIGN != 0)
+	{
+		CKTSO_UnmapBinaryMatrix(m);
+		return -3;
+	}
+	const unsigned long long isize = (h->flags & CKTSO_BIN_INDEX64) ? sizeof(long long) : sizeof(int);
+	const unsigned long long vsize = sizeof(double) * ((h->flags & CKTSO_BIN_COMPLEX) ? 2 : 1);
+	/*counts are compared by division, so that a huge n or nnz cannot wrap the end offsets around*/
+	const unsigned long long n1 = (unsigned long long)h->n + 1, nnz = (unsigned long long)h->nnz;
+	if (h->ap > size || h->ai > size || h->ax > size
+		|| n1 > (size - h->ap) / isize || nnz > (size - h->ai) / isize || nnz > (size - h->ax) / vsize
+		|| (!(h->flags & CKTSO_BIN_INDEX64) && (h->n > INT_MAX || h->nnz > INT_MAX)))
+	{
+		CKTSO_UnmapBinaryMatrix(m);
+		return -3;
+	}
+	m->header = *h;
+	m->ap = (char *)base + h->ap;
+	m->ai = (char *)base + h->ai;
+	m->ax = (double *)((char *)base + h->ax);
+	const long long last = (h->flags & CKTSO_BIN_INDEX64) ? ((const long long *)m->ap)[h->n] : (long long)((const int *)m->ap)[h->n];
+	if (last != h->nnz)
+	{
+		CKTSO_UnmapBinaryMatrix(m);
+		return -3;
+	}
+	return 0;
+}
+
+#endif
@@ -0,0 +1,1057 @@
+/*Host reference accelerator of CKTSO-GPU*/
+/*Implements the CKTSO-GPU interfaces with multi-threaded CPU code, for machines without a usable GPU*/
+#ifndef __CKTSO_GPU_HOST__
+#define __CKTSO_GPU_HOST__
+
+#include "cktso-gpu.h"
+
+/********** error code **********
+* The host accelerator returns the following codes:
+* -1:   invalid instance handle
+* -2:   argument error
+* -3:   invalid matrix
+* -4:   insufficient host memory
+* -6:   matrix is numerically singular
+* -52:  accelerator not initialized
+* -53:  matrix not refactorized by the accelerator
+* -54:  host matrix not set (CKTSO(_L)_SetHostMatrix has not been called)
+* -55:  operation not supported by a GPU-accelerator
+* -56:  file cannot be opened or read
+* Accelerators created by CKTSO(_L)_CreateAccelerator on a GPU return CKTSO-GPU codes (see cktso-gpu.h)
+********************************/
+
+/********** input parameters int [] **********
+* Same layout as CKTSO-GPU (see cktso-gpu.h), interpreted by the host accelerator as follows:
+* input parm[0]: timer. [default 0]: no timer | >0: microsecond/us-level timer | <0: millisecond/ms-level timer
+* input parm[1]: threshold for bulk-pipeline refactor. [default 128] leading levels with at least this many columns are refactorized in bulk mode, the rest in pipeline mode
+* input parm[2]: factors array allocation ratio (percentage). [default 110 (=1.1)]
+* input parm[3]: whether to reallocate memories when size reduces. [default 0]
+* input parm[4]: ignored
+* input parm[5]: #threads for refactor. [default 0] all threads of the accelerator
+* input parm[6]: ignored
+* input parm[7]: #threads for CKTSO(_L)_GpuSolveMany. [default 0] all threads of the accelerator
+* input parm[8]: batch count, #value sets sharing the factors structure, read by CKTSO(_L)_InitializeGpuAccelerator. [default 1]
+* input parm[9]: bypass tolerance (in 1e-9, relative). [default 0] disabled | >0: CKTSO(_L)_GpuRefactorize and CKTSO(_L)_GpuRefactorizeAndSolve keep the current factors when |ax[i]-a[i]| <= parm[9]*1e-9*|a[i]| for every value, a[] being the values of the current factors
+* input parm[10]: factors precision, read by CKTSO(_L)_InitializeGpuAccelerator. [default 0]: double | nonzero: single, halving factors memory (output parm[4]), computing stays in double
+* input parm[11]: max #iterative refinement steps of CKTSO(_L)_GpuSolve and CKTSO(_L)_GpuRefactorizeAndSolve, against the double values. [default 0] no refinement. CKTSO(_L)_GpuSolveMany, CKTSO(_L)_GpuSolveBatch, CKTSO(_L)_GpuSolveSplit and CKTSO(_L)_GpuSolveOrdered are not refined
+* input parm[12]: refinement target, refinement stops when ||b-A*x||2/||b||2 <= 10^-parm[12]. [default 12]
+* input parm[13]: incremental re-initialization. [default 1] when CKTSO(_L)_InitializeGpuAccelerator is called again with the same pattern, the ordering is kept, and the leading factor columns whose pivots still meet the tolerance keep their pivots, structure and levels | 0: full re-initialization
+* input parm[14]: tracing. [default 0] disabled | >0: capacity (#spans) of the trace ring, spans of each call, internal phase, bulk level and pipeline thread are recorded, the oldest being overwritten once full. Read at the beginning of each call, a new capacity empties the ring (see CKTSO(_L)_GpuDumpTrace)
+* input parm[15]: dispatch mode, read by a dispatcher only (see CKTSO(_L)_CreateDispatcher). [default 0] automatic | 1: always the CKTSO solver | 2: always the accelerator
+* input parm[16]: #timed trial cycles of each engine before a dispatcher chooses one. [default 3]
+* input parm[17]: drift (percentage) of the chosen engine's cycle time over its calibrated time that makes a dispatcher calibrate again. [default 50]
+* input parm[18]: column ordering of the host accelerator, on the pattern of A+A^T, read by CKTSO(_L)_InitializeGpuAccelerator. [default 0] approximate minimum degree, fill-reducing | 1: reverse Cuthill-McKee, a narrow band but much more fill on circuit matrices
+********************************/
+
+/********** output parameters const long long [] **********
+* output parm[0]: time (in microsecond/us) of CKTSO(_L)_InitializeGpuAccelerator, including host ordering and pivoting
+* output parm[1]: time (in microsecond/us) of CKTSO(_L)_GpuRefactorize, CKTSO(_L)_GpuRefactorizeSplit, CKTSO(_L)_GpuRefactorizeOrdered, CKTSO(_L)_GpuRefactorizeStamps, CKTSO(_L)_GpuRefactorizeBatch, CKTSO(_L)_GpuRefactorizeDelta, CKTSO(_L)_GpuRefactorizeMasked or CKTSO(_L)_GpuFrequencySweep (all points)
+* output parm[2]: time (in microsecond/us) of CKTSO(_L)_GpuSolve, CKTSO(_L)_GpuSolveSplit, CKTSO(_L)_GpuSolveOrdered, CKTSO(_L)_GpuSolveMany, CKTSO(_L)_GpuSolveBatch or CKTSO(_L)_GpuSolveSparse
+* output parm[3]: host memory usage (in bytes), excluding factors
+* output parm[4]: factors memory usage (in bytes) of all value sets, which CKTSO-GPU keeps in GPU memory
+* output parm[5]: host memory requirement (in bytes) when -4 is returned (for the last failed allocation)
+* output parm[6]: always 0
+* output parm[7]: #nonzeros of factors (L+U, including diagonal)
+* output parm[8]: #levels of the refactor schedule
+* output parm[9]: #levels refactorized in bulk mode
+* output parm[10]: time (in microsecond/us) of CKTSO(_L)_GpuRefactorizeAndSolve, of which parm[1] is refactor (with the first substitution sweep) and parm[2] is the rest
+* output parm[11]: #factor columns recomputed by the last refactor of factor 0 (n for a full refactor, 0 when bypassed)
+* output parm[12]: whether the last CKTSO(_L)_GpuRefactorize or CKTSO(_L)_GpuRefactorizeAndSolve was bypassed (see input parm[9])
+* output parm[13]: #bypassed refactors since the accelerator was created
+* output parm[14]: relative residual ||b-A*x||2/||b||2 (in 1e-18) after refinement of the last solve, 0 when refinement is disabled
+* output parm[15]: #refinement steps of the last solve
+* output parm[16]: whether the last CKTSO(_L)_InitializeGpuAccelerator restored its symbolic structure from the cache (see CKTSO(_L)_SetHostCache)
+* output parm[17]: #factor columns pivoted by the last CKTSO(_L)_InitializeGpuAccelerator (n for a full initialization, 0 when all pivots were kept, see input parm[13])
+* output parm[18]: #floating-point operations of a full refactor (complex operations counted as 4 real ones), set by CKTSO(_L)_InitializeGpuAccelerator
+* output parm[19]: dispatcher only, engine of the current factors (CKTSO_ENGINE_*), -1 before the first refactor
+* output parm[20]: dispatcher only, why that engine was chosen (CKTSO_DISPATCH_*)
+* output parm[21]: dispatcher only, calibrated cycle time (in nanosecond/ns, a refactor and the solves until the next one) of the CKTSO solver, 0 when not calibrated
+* output parm[22]: dispatcher only, calibrated cycle time (in nanosecond/ns) of the accelerator, 0 when not calibrated
+* output parm[23]: dispatcher only, #calibrations since the dispatcher was created
+* output parm[24]: dispatcher only, estimated refactor parallelism (in 1e-2, flops over critical path flops, see CKTSO_GPU_SCHEDULE), 0 when the accelerator does not expose its schedule
+* output parm[25]: dispatcher only, share (percentage) of refactor flops in the pipelined tail levels, 0 when the accelerator does not expose its schedule
+* output parm[26]: #factor columns computed by both sweeps of the last CKTSO(_L)_GpuSolveSparse (2n for a full solve)
+* output parm[27]: whether the last CKTSO(_L)_GpuSolveSparse reused a cached plan of the same pattern
+* output parm[28]: first frequency point of the last CKTSO(_L)_GpuFrequencySweep that failed to refactorize, -1 when none failed
+********************************/
+
+/********** dispatch **********
+* Engines and reasons reported by a dispatcher in output parm[19] and output parm[20], see CKTSO(_L)_CreateDispatcher
+********************************/
+#define CKTSO_ENGINE_SOLVER             0 /*CKTSO solver instance (CPU)*/
+#define CKTSO_ENGINE_ACCELERATOR        1 /*accelerator created by CKTSO(_L)_CreateAccelerator*/
+#define CKTSO_DISPATCH_FORCED           0 /*input parm[15] is nonzero*/
+#define CKTSO_DISPATCH_ESTIMATE         1 /*the factor structure is too small or too sequential for the accelerator, no trial is run*/
+#define CKTSO_DISPATCH_TRIAL            2 /*calibrating, the engines take turns*/
+#define CKTSO_DISPATCH_CALIBRATED       3 /*the engine with the shorter median cycle time in the trials*/
+
+/********** statistics **********
+* A host accelerator keeps counters of all its calls since it was created (or last reset), see CKTSO(_L)_GpuGetStats
+* Phases (indexes of calls, total_ns and max_ns), each the routine of the same name:
+********************************/
+#define CKTSO_STATS_SET_MATRIX          0
+#define CKTSO_STATS_INITIALIZE          1
+#define CKTSO_STATS_REFACTORIZE         2 /*and CKTSO(_L)_GpuRefactorizeSplit, CKTSO(_L)_GpuRefactorizeOrdered, CKTSO(_L)_GpuRefactorizeStamps*/
+#define CKTSO_STATS_SOLVE               3 /*and CKTSO(_L)_GpuSolveSplit, CKTSO(_L)_GpuSolveOrdered*/
+#define CKTSO_STATS_SOLVE_MANY          4
+#define CKTSO_STATS_REFACTORIZE_SOLVE   5
+#define CKTSO_STATS_REFACTORIZE_DELTA   6
+#define CKTSO_STATS_REFACTORIZE_MASKED  7
+#define CKTSO_STATS_REFACTORIZE_BATCH   8
+#define CKTSO_STATS_SOLVE_BATCH         9
+#define CKTSO_STATS_SOLVE_SPARSE        10
+#define CKTSO_STATS_FREQUENCY_SWEEP     11
+#define CKTSO_STATS_PHASES              12
+#define CKTSO_STATS_BINS                80
+
+typedef struct
+{
+	long long calls[CKTSO_STATS_PHASES];
+	long long total_ns[CKTSO_STATS_PHASES]; /*cumulative time (in nanosecond/ns)*/
+	long long max_ns[CKTSO_STATS_PHASES];
+	long long bytes_in; /*bytes read from the caller's arrays: matrix, values, change lists and right-hand-side vectors*/
+	long long bytes_out; /*bytes written to the caller's solution vectors*/
+	long long bypassed; /*refactors skipped by bypass (see input parm[9])*/
+	long long reinitializations; /*CKTSO(_L)_InitializeGpuAccelerator calls after the first one*/
+	long long incremental; /*re-initializations that kept the ordering (see input parm[13])*/
+	long long cache_hits; /*initializations restored from the cache (see CKTSO(_L)_SetHostCache)*/
+	long long refactor_hist[CKTSO_STATS_BINS]; /*latency histogram of CKTSO(_L)_GpuRefactorize, CKTSO(_L)_GpuRefactorizeSplit, CKTSO(_L)_GpuRefactorizeOrdered, CKTSO(_L)_GpuRefactorizeStamps, CKTSO(_L)_GpuRefactorizeDelta and CKTSO(_L)_GpuRefactorizeMasked*/
+	long long solve_hist[CKTSO_STATS_BINS]; /*latency histogram of CKTSO(_L)_GpuSolve, CKTSO(_L)_GpuSolveSplit, CKTSO(_L)_GpuSolveOrdered and CKTSO(_L)_GpuSolveBatch*/
+	/*half-octave bins: bin 0 counts latencies below 1 ns, bin 1 of 1 ns, bin k = 2m >= 2 of [2^m, 1.5*2^m) ns, bin k = 2m+1 of [1.5*2^m, 2^(m+1)) ns, the last bin is open*/
+} CKTSO_GPU_STATS;
+
+/********** schedule **********
+* Dependency structure built by CKTSO(_L)_InitializeGpuAccelerator, see CKTSO(_L)_GpuGetSchedule
+* Factor column k depends on column j < k for each nonzero U(j,k). Level l holds the columns whose longest dependency chain has l columns
+********************************/
+typedef struct
+{
+	long long n;
+	long long levels; /*#levels, the critical path length in columns*/
+	long long bulk_levels; /*#leading levels refactorized in bulk mode (see input parm[1]), the rest is pipelined*/
+	long long bulk_columns; /*#columns of the bulk levels*/
+	long long max_width; /*#columns of the widest level*/
+	long long edges; /*#dependencies, nonzeros of U excluding the diagonal*/
+	long long flops; /*#floating-point operations of a refactor, same as output parm[18]*/
+	long long critical_flops; /*#floating-point operations along the heaviest dependency chain*/
+	double parallelism; /*flops / critical_flops, an upper bound of the refactor speedup over one thread*/
+} CKTSO_GPU_SCHEDULE;
+
+typedef struct __CKTSO_GPU_ASYNC *ICktSoGpuAsync;
+typedef struct __CKTSO_GPU_REQUEST *ICktSoGpuRequest;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+* CKTSO_CreateHostAccelerator (CKTSO_L_CreateHostAccelerator): creates host accelerator instance and retrieves parameter array pointers
+* The instance is used through the same interfaces as a GPU-accelerator
+* @accel: pointer to an ICktSoGpu (ICktSoGpu_L) instance that retrieves created accelerator instance handle
+* @iparm: pointer to input parameter list array (see annotations above)
+* @oparm: pointer to output parameter list array (see annotations above)
+* @threads: #worker threads, 0 for all hardware threads
+*/
+int CKTSO_CreateHostAccelerator
+(
+	_OUT_ ICktSoGpu *accel,
+	_OUT_ int **iparm,
+	_OUT_ const long long **oparm,
+	_IN_ int threads
+);
+
+int CKTSO_L_CreateHostAccelerator
+(
+	_OUT_ ICktSoGpu_L *accel,
+	_OUT_ int **iparm,
+	_OUT_ const long long **oparm,
+	_IN_ int threads
+);
+
+/*
+* CKTSO_CreateAccelerator (CKTSO_L_CreateAccelerator): creates a GPU-accelerator, or a host accelerator when no GPU is wanted or available
+* A host accelerator is created when gpuid < 0, when environment variable CKTSO_GPU_HOST is set to a nonzero number,
+* or when CKTSO(_L)_CreateGpuAccelerator returns cudaErrorNoDevice (100)
+* @gpuid: GPU id for refactor and solve, or -1 for the host accelerator
+*/
+int CKTSO_CreateAccelerator
+(
+	_OUT_ ICktSoGpu *accel,
+	_OUT_ int **iparm,
+	_OUT_ const long long **oparm,
+	_IN_ int gpuid
+);
+
+int CKTSO_L_CreateAccelerator
+(
+	_OUT_ ICktSoGpu_L *accel,
+	_OUT_ int **iparm,
+	_OUT_ const long long **oparm,
+	_IN_ int gpuid
+);
+
+/*
+* CKTSO_CreateDispatcher (CKTSO_L_CreateDispatcher): creates an accelerator that routes each refactor to the faster of two engines,
+* the CKTSO solver instance given to CKTSO(_L)_InitializeGpuAccelerator, or an accelerator created by CKTSO(_L)_CreateAccelerator(gpuid)
+* Solves go to the engine of the current factors. After each initialization (e.g., a new pivot sequence), the factor structure is estimated
+* (when the accelerator is a host accelerator), then unless it settles the choice, the engines take input parm[16] trial cycles each,
+* and the one with the shorter median is kept until its cycle time drifts by input parm[17] percent. See output parm[19..25]
+* Input parm[0..14] and parm[18], and output parm[0..18] are passed to and from the accelerator. CKTSO(_L)_SetHostMatrix and CKTSO(_L)_SetHostCache
+* are forwarded to it, the other extension routines treat a dispatcher as a GPU-accelerator
+* The solver instance is refactorized and solved by the dispatcher, so it must not be used by another thread meanwhile
+* @accel: pointer to an ICktSoGpu (ICktSoGpu_L) instance that retrieves created dispatcher handle
+* @iparm: pointer to input parameter list array (see annotations above)
+* @oparm: pointer to output parameter list array (see annotations above)
+* @gpuid: same as CKTSO(_L)_CreateAccelerator
+*/
+int CKTSO_CreateDispatcher
+(
+	_OUT_ ICktSoGpu *accel,
+	_OUT_ int **iparm,
+	_OUT_ const long long **oparm,
+	_IN_ int gpuid
+);
+
+int CKTSO_L_CreateDispatcher
+(
+	_OUT_ ICktSoGpu_L *accel,
+	_OUT_ int **iparm,
+	_OUT_ const long long **oparm,
+	_IN_ int gpuid
+);
+
+/*
+* CKTSO_SetHostMatrix (CKTSO_L_SetHostMatrix): gives the matrix to a host accelerator
+* The host accelerator computes its own ordering and pivot sequence from these values when CKTSO(_L)_InitializeGpuAccelerator is called,
+* so call this routine with the same arrays as CKTSO(_L)_Analyze before the first initialization, and again with new values when pivoting is redone
+* (re-initialization with the same pattern only pivots again the trailing columns that need it, see input parm[13])
+* Arrays are copied. For a GPU-accelerator this routine does nothing and returns 0
+* @accel: accelerator instance handle
+* @is_complex: real or complex matrix, same as CKTSO(_L)_Analyze
+* @n: matrix dimension
+* @ap, ai, ax: matrix in the same format as CKTSO(_L)_Analyze
+*/
+int CKTSO_SetHostMatrix
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ bool is_complex,
+	_IN_ int n,
+	_IN_ const int ap[],
+	_IN_ const int ai[],
+	_IN_ const double ax[]
+);
+
+int CKTSO_L_SetHostMatrix
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ bool is_complex,
+	_IN_ long long n,
+	_IN_ const long long ap[],
+	_IN_ const long long ai[],
+	_IN_ const double ax[]
+);
+
+/*
+* CKTSO_IsHostAccelerator (CKTSO_L_IsHostAccelerator): whether an accelerator instance is a host accelerator
+* Output parameters beyond CKTSO-GPU's (see cktso-gpu.h) are only valid for a host accelerator
+*/
+bool CKTSO_IsHostAccelerator
+(
+	_IN_ ICktSoGpu accel
+);
+
+bool CKTSO_L_IsHostAccelerator
+(
+	_IN_ ICktSoGpu_L accel
+);
+
+/*
+* CKTSO_SetHostCache (CKTSO_L_SetHostCache): sets the directory where a host accelerator saves and restores symbolic structures
+* CKTSO(_L)_InitializeGpuAccelerator looks up a file named by a hash of the matrix pattern (and the ordering, input parm[18]). On a hit, ordering and pivoting are skipped:
+* the saved pivot sequence, factors structure and level schedule are used, provided that the factors of the current values meet
+* the pivoting tolerance (otherwise the matrix is factorized again). On a miss, the structure is saved after factorization
+* Files are checked for version, pattern and integrity (checksum) before use, a failed check counts as a miss
+* The initial directory is the environment variable CKTSO_GPU_HOST_CACHE, if set. For a GPU-accelerator this routine does nothing and returns 0
+* @accel: accelerator instance handle
+* @dir: existing directory, shared by processes, NULL or empty disables the cache
+*/
+int CKTSO_SetHostCache
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ const char dir[]
+);
+
+int CKTSO_L_SetHostCache
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ const char dir[]
+);
+
+/*
+* CKTSO_GpuSolveMany (CKTSO_L_GpuSolveMany): solves multiple right-hand-side vectors
+* A host accelerator sweeps the factors once per chunk of vectors and solves chunks in parallel (iparm[7]),
+* a GPU-accelerator solves the vectors one by one by CKTSO(_L)_GpuSolve
+* @nrhs: #right-hand-side vectors
+* @b: double array of length ldb*nrhs, vector i starts at b + i*ldb, in host memory
+* @ldb: leading dimension of b, in doubles (>= n for real matrix, >= 2*n for complex matrix)
+* @x: double array of length ldx*nrhs to get solutions, in host memory
+* @ldx: leading dimension of x, in doubles
+* @row0_column1: row or column mode
+*/
+int CKTSO_GpuSolveMany
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ int nrhs,
+	_IN_ const double b[],
+	_IN_ int ldb,
+	_OUT_ double x[], /*x address can be same as b address if ldx = ldb*/
+	_IN_ int ldx,
+	_IN_ bool row0_column1
+);
+
+int CKTSO_L_GpuSolveMany
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ long long nrhs,
+	_IN_ const double b[],
+	_IN_ long long ldb,
+	_OUT_ double x[], /*x address can be same as b address if ldx = ldb*/
+	_IN_ long long ldx,
+	_IN_ bool row0_column1
+);
+
+/*
+* CKTSO_GpuRefactorizeAndSolve (CKTSO_L_GpuRefactorizeAndSolve): refactorizes matrix and solves solution in one call
+* A host accelerator starts the substitutions right after refactor without another call, and in sequential mode the first sweep follows each factor column
+* A GPU-accelerator calls CKTSO(_L)_GpuRefactorize and CKTSO(_L)_GpuSolve
+* @ax: same as CKTSO(_L)_GpuRefactorize
+* @b, x, row0_column1: same as CKTSO(_L)_GpuSolve
+*/
+int CKTSO_GpuRefactorizeAndSolve
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ const double ax[],
+	_IN_ const double b[],
+	_OUT_ double x[], /*x address can be same as b address*/
+	_IN_ bool row0_column1
+);
+
+int CKTSO_L_GpuRefactorizeAndSolve
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ const double ax[],
+	_IN_ const double b[],
+	_OUT_ double x[], /*x address can be same as b address*/
+	_IN_ bool row0_column1
+);
+
+/*
+* CKTSO_GpuRefactorizeSplit (CKTSO_L_GpuRefactorizeSplit): same as CKTSO(_L)_GpuRefactorize for a complex matrix,
+* with real and imaginary parts of the values in separate arrays (structure of arrays)
+* The host accelerator interleaves them once into the values it keeps anyway (see input parm[9] and parm[11]),
+* the factors stay interleaved, which keeps both parts of an entry in one cache line. Returns -55 for a GPU-accelerator
+* @re: double array of length ap[n], real parts
+* @im: double array of length ap[n], imaginary parts
+*/
+int CKTSO_GpuRefactorizeSplit
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ const double re[],
+	_IN_ const double im[]
+);
+
+int CKTSO_L_GpuRefactorizeSplit
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ const double re[],
+	_IN_ const double im[]
+);
+
+/*
+* CKTSO_GpuSolveSplit (CKTSO_L_GpuSolveSplit): same as CKTSO(_L)_GpuSolve for a complex matrix,
+* with real and imaginary parts of b and x in separate arrays, read and written by the permutations of the substitutions
+* Solutions are not refined (see input parm[11]). Returns -55 for a GPU-accelerator
+* @bre, bim: double arrays of length n, real and imaginary parts of the right-hand-side vector
+* @xre, xim: double arrays of length n to get the real and imaginary parts of the solution
+* @row0_column1: row or column mode
+*/
+int CKTSO_GpuSolveSplit
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ const double bre[],
+	_IN_ const double bim[],
+	_OUT_ double xre[], /*xre and xim addresses can be same as bre and bim addresses*/
+	_OUT_ double xim[],
+	_IN_ bool row0_column1
+);
+
+int CKTSO_L_GpuSolveSplit
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ const double bre[],
+	_IN_ const double bim[],
+	_OUT_ double xre[], /*xre and xim addresses can be same as bre and bim addresses*/
+	_OUT_ double xim[],
+	_IN_ bool row0_column1
+);
+
+/*
+* CKTSO_GpuGetFactorOrder (CKTSO_L_GpuGetFactorOrder): gets the factor storage order of a host accelerator,
+* so that values and vectors can be written in that order by the caller (see CKTSO(_L)_GpuRefactorizeOrdered and CKTSO(_L)_GpuSolveOrdered)
+* The order is set by CKTSO(_L)_InitializeGpuAccelerator. Returns -55 for a GPU-accelerator
+* @fnz: pointer to get #factor-ordered values (output parm[7]), can be NULL
+* @vmap: int (long long) array of length ap[n] to get the position of each nonzero of ax in factor order, can be NULL
+* @ppos: int (long long) array of length n to get the factor position of entry i of b in column mode and of x in row mode, can be NULL
+* @qpos: int (long long) array of length n to get the factor position of entry i of b in row mode and of x in column mode, can be NULL
+*/
+int CKTSO_GpuGetFactorOrder
+(
+	_IN_ ICktSoGpu accel,
+	_OUT_ int *fnz,
+	_OUT_ int vmap[],
+	_OUT_ int ppos[],
+	_OUT_ int qpos[]
+);
+
+int CKTSO_L_GpuGetFactorOrder
+(
+	_IN_ ICktSoGpu_L accel,
+	_OUT_ long long *fnz,
+	_OUT_ long long vmap[],
+	_OUT_ long long ppos[],
+	_OUT_ long long qpos[]
+);
+
+/*
+* CKTSO_GpuRefactorizeOrdered (CKTSO_L_GpuRefactorizeOrdered): same as CKTSO(_L)_GpuRefactorize, with values in factor order,
+* which are read column by column without mapping each nonzero
+* The values of ax are not kept unless refinement is enabled (input parm[11]), so bypass (input parm[9]) does not apply,
+* and CKTSO(_L)_GpuRefactorizeDelta and CKTSO(_L)_GpuRefactorizeMasked return -53 until the next CKTSO(_L)_GpuRefactorize
+* Returns -55 for a GPU-accelerator
+* @fx: double array of length fnz (2*fnz for a complex matrix), nonzero p of ax at fx[vmap[p]], all other entries 0
+*/
+int CKTSO_GpuRefactorizeOrdered
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ const double fx[]
+);
+
+int CKTSO_L_GpuRefactorizeOrdered
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ const double fx[]
+);
+
+/*
+* CKTSO_GpuSolveOrdered (CKTSO_L_GpuSolveOrdered): same as CKTSO(_L)_GpuSolve, with b and x in factor order, skipping both permutations
+* Row mode: b[i] at qpos[i] and x[i] at ppos[i], column mode: b[i] at ppos[i] and x[i] at qpos[i] (see CKTSO(_L)_GpuGetFactorOrder)
+* The host accelerator does not scale the matrix, so no scaling applies. Solutions are not refined. Returns -55 for a GPU-accelerator
+* @b: double array of length n (2*n for a complex matrix), right-hand-side vector in factor order
+* @x: double array of length n (2*n for a complex matrix) to get the solution in factor order
+* @row0_column1: row or column mode
+*/
+int CKTSO_GpuSolveOrdered
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ const double b[],
+	_OUT_ double x[], /*x address can be same as b address*/
+	_IN_ bool row0_column1
+);
+
+int CKTSO_L_GpuSolveOrdered
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ const double b[],
+	_OUT_ double x[], /*x address can be same as b address*/
+	_IN_ bool row0_column1
+);
+
+/*
+* CKTSO_GpuSetStamps (CKTSO_L_GpuSetStamps): registers the (row, col) positions of element stamps, several stamps can add to one matrix value
+* The host accelerator sorts them by the factor position they add to, so that CKTSO(_L)_GpuRefactorizeStamps sums each position in one thread
+* without conflicts. Call this routine after CKTSO(_L)_InitializeGpuAccelerator, the stamps are planned again by each later initialization
+* Returns -2 when a stamp is outside the pattern, -55 for a GPU-accelerator
+* @nstamps: #stamps
+* @row: int (long long) array of length nstamps, row index (as in ai) of each stamp
+* @col: int (long long) array of length nstamps, column index (as in ap) of each stamp
+*/
+int CKTSO_GpuSetStamps
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ int nstamps,
+	_IN_ const int row[],
+	_IN_ const int col[]
+);
+
+int CKTSO_L_GpuSetStamps
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ long long nstamps,
+	_IN_ const long long row[],
+	_IN_ const long long col[]
+);
+
+/*
+* CKTSO_GpuRefactorizeStamps (CKTSO_L_GpuRefactorizeStamps): sums stamp values into the matrix values in factor order and refactorizes,
+* same as CKTSO(_L)_GpuRefactorizeOrdered otherwise. Matrix values no stamp adds to are 0
+* Returns -2 when no stamps are planned (see CKTSO(_L)_GpuSetStamps), -55 for a GPU-accelerator
+* @sv: double array of length nstamps (2*nstamps for a complex matrix), stamp values in registration order
+*/
+int CKTSO_GpuRefactorizeStamps
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ const double sv[]
+);
+
+int CKTSO_L_GpuRefactorizeStamps
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ const double sv[]
+);
+
+/*
+* CKTSO_GpuRefactorizeDelta (CKTSO_L_GpuRefactorizeDelta): refactorizes after a few matrix values changed
+* Changed values are applied to the values of the last refactor, and only the factor columns holding them,
+* plus the columns depending on those, are recomputed. #recomputed columns is reported in oparm[11]
+* Call this routine after CKTSO(_L)_GpuRefactorize has been called. Not supported by a GPU-accelerator (-55)
+* @nchg: #changed values
+* @idx: int (long long) array of length nchg, positions of changed values in ax[] (0 ... ap[n]-1)
+* @val: double array of length nchg (2*nchg for complex matrix), new values
+*/
+int CKTSO_GpuRefactorizeDelta
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ int nchg,
+	_IN_ const int idx[],
+	_IN_ const double val[]
+);
+
+int CKTSO_L_GpuRefactorizeDelta
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ long long nchg,
+	_IN_ const long long idx[],
+	_IN_ const double val[]
+);
+
+/*
+* CKTSO_GpuRefactorizeMasked (CKTSO_L_GpuRefactorizeMasked): same as CKTSO(_L)_GpuRefactorizeDelta, with changes given by a bitmap
+* Only the flagged values of ax are read. A GPU-accelerator refactorizes the full matrix by CKTSO(_L)_GpuRefactorize
+* @changed: bitmap of ap[n] bits, value p changed if (changed[p/8] >> (p%8)) & 1
+* @ax: same as CKTSO(_L)_GpuRefactorize
+*/
+int CKTSO_GpuRefactorizeMasked
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ const unsigned char changed[],
+	_IN_ const double ax[]
+);
+
+int CKTSO_L_GpuRefactorizeMasked
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ const unsigned char changed[],
+	_IN_ const double ax[]
+);
+
+/*
+* CKTSO_GpuRefactorizeBatch (CKTSO_L_GpuRefactorizeBatch): refactorizes k matrices with the same pattern and pivot sequence in one call
+* The accelerator must be initialized with iparm[8] >= k. Value set i is stored as factor i, factor 0 is the one used by CKTSO(_L)_GpuSolve
+* A host accelerator refactorizes value sets in parallel when k is not less than #threads (iparm[5]), otherwise one after another in parallel mode
+* A GPU-accelerator only accepts k = 1
+* @ax: array of k pointers to double arrays of length ap[n], in host memory
+* @k: #value sets
+*/
+int CKTSO_GpuRefactorizeBatch
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ const double *ax[],
+	_IN_ int k
+);
+
+int CKTSO_L_GpuRefactorizeBatch
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ const double *ax[],
+	_IN_ int k
+);
+
+/*
+* CKTSO_GpuSolveBatch (CKTSO_L_GpuSolveBatch): solves with factor k of a batch
+* @k: factor index, 0 ... iparm[8]-1
+* @b, x, row0_column1: same as CKTSO(_L)_GpuSolve
+*/
+int CKTSO_GpuSolveBatch
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ int k,
+	_IN_ const double b[],
+	_OUT_ double x[], /*x address can be same as b address*/
+	_IN_ bool row0_column1
+);
+
+int CKTSO_L_GpuSolveBatch
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ int k,
+	_IN_ const double b[],
+	_OUT_ double x[], /*x address can be same as b address*/
+	_IN_ bool row0_column1
+);
+
+/*
+* CKTSO_GpuSolveSparse (CKTSO_L_GpuSolveSparse): solves with a sparse right-hand-side vector, for the requested solution entries only
+* The host accelerator computes the factor columns reached from the nonzeros of b, pruned to those the requested entries depend on,
+* and keeps the plans of the last 16 patterns (see output parm[26..27]). Solutions are not refined (see input parm[11])
+* Returns -55 for a GPU-accelerator
+* @nnz: #nonzeros of b
+* @idx: int (long long) array of length nnz, indexes of the nonzeros of b, duplicated indexes are summed
+* @val: double array of length nnz (2*nnz for a complex matrix), values of the nonzeros of b
+* @nout: #requested solution entries
+* @out: int (long long) array of length nout, indexes of the requested solution entries, NULL for all of them
+* @x: double array that retrieves the solution, of length nout (x[r] = solution entry out[r]), or n when out is NULL (2x for a complex matrix)
+* @row0_column1: row or column mode
+*/
+int CKTSO_GpuSolveSparse
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ int nnz,
+	_IN_ const int idx[],
+	_IN_ const double val[],
+	_IN_ int nout,
+	_IN_ const int out[],
+	_OUT_ double x[],
+	_IN_ bool row0_column1
+);
+
+int CKTSO_L_GpuSolveSparse
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ long long nnz,
+	_IN_ const long long idx[],
+	_IN_ const double val[],
+	_IN_ long long nout,
+	_IN_ const long long out[],
+	_OUT_ double x[],
+	_IN_ bool row0_column1
+);
+
+/*
+* CKTSO_GpuFrequencySweep (CKTSO_L_GpuFrequencySweep): solves (G + j*omega*C) x = b for a list of angular frequencies omega
+* The accelerator must be initialized with a complex matrix, G + j*omega*C must have its pattern (with explicit zeros where needed)
+* and must meet the pivoting tolerance with its pivot sequence. The complex values of each point are formed by the accelerator
+* A host accelerator spreads points over min(#threads (iparm[5]), batch count (iparm[8])) workers, each forming, refactorizing
+* and solving its own points, or refactorizes each point in parallel mode when there is one worker. Solutions are not refined
+* The factors of value sets 0 ... workers-1 are overwritten: call CKTSO(_L)_GpuRefactorize before solving again
+* When points fail to refactorize, their solutions are not set, the others are, and the code of the first one is returned (see output parm[28])
+* Returns -55 for a GPU-accelerator
+* @g: double array of length ap[n], real parts, in the order of the matrix values
+* @c: double array of length ap[n], imaginary parts divided by omega, same order
+* @npoints: #frequency points
+* @omega: double array of length npoints, angular frequencies
+* @b: double array, complex right-hand-side vector of point i at b + i*ldb
+* @ldb: leading dimension of b, in doubles (>= 2*n), 0 for the same vector at all points
+* @x: double array of length ldx*npoints to get the complex solutions, solution of point i at x + i*ldx. Must not overlap b when ldb is 0
+* @ldx: leading dimension of x, in doubles (>= 2*n)
+* @row0_column1: row or column mode
+*/
+int CKTSO_GpuFrequencySweep
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ const double g[],
+	_IN_ const double c[],
+	_IN_ int npoints,
+	_IN_ const double omega[],
+	_IN_ const double b[],
+	_IN_ int ldb,
+	_OUT_ double x[], /*x address can be same as b address if ldx = ldb*/
+	_IN_ int ldx,
+	_IN_ bool row0_column1
+);
+
+int CKTSO_L_GpuFrequencySweep
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ const double g[],
+	_IN_ const double c[],
+	_IN_ long long npoints,
+	_IN_ const double omega[],
+	_IN_ const double b[],
+	_IN_ long long ldb,
+	_OUT_ double x[], /*x address can be same as b address if ldx = ldb*/
+	_IN_ long long ldx,
+	_IN_ bool row0_column1
+);
+
+/*
+* CKTSO_CreateGpuAsync (CKTSO_L_CreateGpuAsync): creates an asynchronous queue for an accelerator
+* Requests of one queue are executed in order by a worker thread of the queue, requests of different queues run concurrently
+* Create only one queue per accelerator, and do not call the accelerator directly while requests are pending
+* @async: pointer to an ICktSoGpuAsync instance that retrieves created queue handle
+* @accel: accelerator instance handle (GPU-accelerator or host accelerator)
+*/
+int CKTSO_CreateGpuAsync
+(
+	_OUT_ ICktSoGpuAsync *async,
+	_IN_ ICktSoGpu accel
+);
+
+int CKTSO_L_CreateGpuAsync
+(
+	_OUT_ ICktSoGpuAsync *async,
+	_IN_ ICktSoGpu_L accel
+);
+
+/*
+* CKTSO_DestroyGpuAsync: waits for all pending requests and destroys the queue, the accelerator is not destroyed
+* @async: queue handle returned by CKTSO(_L)_CreateGpuAsync
+*/
+int CKTSO_DestroyGpuAsync
+(
+	_IN_ ICktSoGpuAsync async
+);
+
+/*
+* CKTSO_GpuRefactorizeAsync: queues CKTSO(_L)_GpuRefactorize and returns immediately
+* ax must not be changed or freed before the request completes
+* @async: queue handle returned by CKTSO(_L)_CreateGpuAsync
+* @ax: same as CKTSO(_L)_GpuRefactorize
+* @req: pointer to an ICktSoGpuRequest instance that retrieves the request handle, or NULL if completion is not needed
+*/
+int CKTSO_GpuRefactorizeAsync
+(
+	_IN_ ICktSoGpuAsync async,
+	_IN_ const double ax[],
+	_OUT_ ICktSoGpuRequest *req
+);
+
+/*
+* CKTSO_GpuSolveAsync: queues CKTSO(_L)_GpuSolve and returns immediately
+* b must not be changed or freed, and x must not be read, before the request completes
+* @async: queue handle returned by CKTSO(_L)_CreateGpuAsync
+* @b, x, row0_column1: same as CKTSO(_L)_GpuSolve
+* @req: pointer to an ICktSoGpuRequest instance that retrieves the request handle, or NULL if completion is not needed
+*/
+int CKTSO_GpuSolveAsync
+(
+	_IN_ ICktSoGpuAsync async,
+	_IN_ const double b[],
+	_OUT_ double x[], /*x address can be same as b address*/
+	_IN_ bool row0_column1,
+	_OUT_ ICktSoGpuRequest *req
+);
+
+/*
+* CKTSO_GpuWait: waits for a request, releases the request handle and returns the return code of the queued routine
+* @req: request handle returned by CKTSO_GpuRefactorizeAsync or CKTSO_GpuSolveAsync
+*/
+int CKTSO_GpuWait
+(
+	_IN_ ICktSoGpuRequest req
+);
+
+/*
+* CKTSO_GpuTest: checks whether a request has completed, without blocking. The handle is still valid and CKTSO_GpuWait must be called
+* @req: request handle returned by CKTSO_GpuRefactorizeAsync or CKTSO_GpuSolveAsync
+* @done: retrieves whether the request has completed
+*/
+int CKTSO_GpuTest
+(
+	_IN_ ICktSoGpuRequest req,
+	_OUT_ bool *done
+);
+
+/*
+* CKTSO_Residual (CKTSO_L_Residual): computes r = b - A * x and its norms with multiple threads, for checking solutions
+* Norms are deterministic: row mode results do not depend on #threads, column mode results are reproducible for a given #threads
+* Threads and scratch memory are kept between calls, concurrent calls are serialized
+* Row mode products use AVX2 gathers (real) or paired complex multiplies (complex) on x86 CPUs that have AVX2, with the same results;
+* column mode scatters into per-thread vectors are scalar, for real and complex data
+* @is_complex: whether matrix and vectors are complex
+* @n, ap, ai, ax: matrix, row-wise, same as CKTSO(_L)_SetHostMatrix
+* @x: double array of length n (2n for complex), solution
+* @b: double array of length n (2n for complex), right-hand-side vector
+* @r: double array of length n (2n for complex), retrieves residual. Can be NULL
+* @norms: double array of length 3, retrieves 1-norm, 2-norm and inf-norm of residual (complex entries by modulus)
+* @row0_column1: same as CKTSO(_L)_GpuSolve, row mode for A * x and column mode for A^T * x, A given by rows
+* @threads: #threads, 0 for all hardware threads
+*/
+int CKTSO_Residual
+(
+	_IN_ bool is_complex,
+	_IN_ int n,
+	_IN_ const int ap[],
+	_IN_ const int ai[],
+	_IN_ const double ax[],
+	_IN_ const double x[],
+	_IN_ const double b[],
+	_OUT_ double r[],
+	_OUT_ double norms[],
+	_IN_ bool row0_column1,
+	_IN_ int threads
+);
+
+int CKTSO_L_Residual
+(
+	_IN_ bool is_complex,
+	_IN_ long long n,
+	_IN_ const long long ap[],
+	_IN_ const long long ai[],
+	_IN_ const double ax[],
+	_IN_ const double x[],
+	_IN_ const double b[],
+	_OUT_ double r[],
+	_OUT_ double norms[],
+	_IN_ bool row0_column1,
+	_IN_ int threads
+);
+
+/*
+* CKTSO_ReadMatrixMarket (CKTSO_L_ReadMatrixMarket): loads a square coordinate Matrix Market file
+* The file is memory-mapped and parsed in parallel chunks, entries need not be sorted, column (row) indexes are ascending in each row (column)
+* real, integer, complex and pattern fields (pattern values are 1), general, symmetric, skew-symmetric and hermitian matrices (expanded to full) are supported
+* Returns -3 for an unsupported or invalid file, -56 when the file cannot be read
+* @file: file name
+* @n: retrieves matrix dimension
+* @ap, ai, ax: retrieve matrix arrays, allocated by the loader and released by CKTSO_FreeMatrix, ax has 2 doubles per entry for a complex matrix
+* @is_complex: retrieves whether the matrix is complex
+* @csr: false for compressed columns of the file (the layout read by the demos), true for compressed rows
+* @threads: #threads, 0 for all hardware threads. Threads are kept between calls, concurrent calls parse one at a time
+*/
+int CKTSO_ReadMatrixMarket
+(
+	_IN_ const char file[],
+	_OUT_ int *n,
+	_OUT_ int **ap,
+	_OUT_ int **ai,
+	_OUT_ double **ax,
+	_OUT_ bool *is_complex,
+	_IN_ bool csr,
+	_IN_ int threads
+);
+
+int CKTSO_L_ReadMatrixMarket
+(
+	_IN_ const char file[],
+	_OUT_ long long *n,
+	_OUT_ long long **ap,
+	_OUT_ long long **ai,
+	_OUT_ double **ax,
+	_OUT_ bool *is_complex,
+	_IN_ bool csr,
+	_IN_ int threads
+);
+
+/*
+* CKTSO_FreeMatrix: releases arrays returned by CKTSO(_L)_ReadMatrixMarket
+*/
+void CKTSO_FreeMatrix
+(
+	_IN_ void *ap,
+	_IN_ void *ai,
+	_IN_ double *ax
+);
+
+/*
+* CKTSO_GpuAutotune (CKTSO_L_GpuAutotune): chooses launch parameters by timing candidate configurations on an initialized accelerator
+* GPU-accelerator: iparm[1], iparm[4], iparm[5] are timed by CKTSO(_L)_GpuRefactorize, iparm[6], iparm[7] by CKTSO(_L)_GpuSolve
+* Host accelerator: iparm[1] and iparm[5] (#refactor threads) are timed by CKTSO(_L)_GpuRefactorize, bypass (iparm[9]) is off while timing
+* Entries are searched one at a time from the current iparm (always timed first), each taking its fastest candidate, while candidates fit in the budget
+* The result is written to iparm and stored in db, keyed by n, nnz, a hash of the pattern, the value type and the accelerator kind.
+* When db already holds the key, the stored configuration is applied without timing. Either way, the accelerator is left refactorized with ax
+* @accel: accelerator instance handle, initialized
+* @iparm: input parameter array of accel, as retrieved when accel was created
+* @is_complex, n, ap, ai, ax: matrix, same as CKTSO(_L)_SetHostMatrix
+* @budget: time budget of the search (in millisecond/ms), <=0 for db lookup only
+* @db: tuning database file (text, one record per line), NULL for none. Stores are serialized by an advisory lock on file <db>.lock
+* @found: retrieves whether the configuration came from db. Can be NULL
+* returns 0, a code of the refactor or solve routines, or -56 when db cannot be written (iparm is tuned anyway)
+*/
+int CKTSO_GpuAutotune
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ int iparm[],
+	_IN_ bool is_complex,
+	_IN_ int n,
+	_IN_ const int ap[],
+	_IN_ const int ai[],
+	_IN_ const double ax[],
+	_IN_ int budget,
+	_IN_ const char db[],
+	_OUT_ bool *found
+);
+
+int CKTSO_L_GpuAutotune
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ int iparm[],
+	_IN_ bool is_complex,
+	_IN_ long long n,
+	_IN_ const long long ap[],
+	_IN_ const long long ai[],
+	_IN_ const double ax[],
+	_IN_ int budget,
+	_IN_ const char db[],
+	_OUT_ bool *found
+);
+
+/*
+* CKTSO_GpuDumpTrace (CKTSO_L_GpuDumpTrace): writes the spans recorded by a host accelerator with tracing on (see input parm[14]), oldest first
+* Spans are named after the phases: stage matrix, initialize (factorize, repivot, cache restore, copy factors), refactorize (bypass check,
+* bulk level with its index per thread, pipeline per thread, keep values), solve (scatter, forward sweep, backward sweep, refine), etc.
+* The host accelerator has no device transfers: stage matrix and scatter are its counterparts of the host-to-device copies
+* Tracing costs one pointer test per phase and per level when off. Do not call concurrently with other routines of the instance
+* @accel: accelerator instance handle
+* @file: output file
+* @binary: false for Chrome trace JSON (chrome://tracing, Perfetto UI), true for a compact binary trace, converted by CKTSO_ConvertTrace
+* @clear: whether to empty the ring once written
+* returns 0, -52 (tracing never enabled), -55 for a GPU-accelerator, or -56 (file cannot be written)
+*/
+int CKTSO_GpuDumpTrace
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ const char file[],
+	_IN_ bool binary,
+	_IN_ bool clear
+);
+
+int CKTSO_L_GpuDumpTrace
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ const char file[],
+	_IN_ bool binary,
+	_IN_ bool clear
+);
+
+/*
+* CKTSO_GpuGetStats (CKTSO_L_GpuGetStats): retrieves the counters of a host accelerator
+* Counters are updated with relaxed atomic operations at every call, and can be read from another thread while the instance is running
+* @accel: accelerator instance handle
+* @stats: retrieves the counters
+* @reset: whether to clear the counters once read (each counter is read and cleared atomically, not all together)
+* returns 0, or -55 for a GPU-accelerator
+*/
+int CKTSO_GpuGetStats
+(
+	_IN_ ICktSoGpu accel,
+	_OUT_ CKTSO_GPU_STATS *stats,
+	_IN_ bool reset
+);
+
+int CKTSO_L_GpuGetStats
+(
+	_IN_ ICktSoGpu_L accel,
+	_OUT_ CKTSO_GPU_STATS *stats,
+	_IN_ bool reset
+);
+
+/*
+* CKTSO_DumpStats: writes counters as text: calls, mean and max time per phase, the other counters,
+* and the nonempty bins of both histograms with their median and 99th percentile
+* @stats: counters retrieved by CKTSO(_L)_GpuGetStats
+* @file: output file, appended, NULL for the standard output
+* returns 0, or -56 (file cannot be written)
+*/
+int CKTSO_DumpStats
+(
+	_IN_ const CKTSO_GPU_STATS *stats,
+	_IN_ const char file[]
+);
+
+/*
+* CKTSO_GpuGetSchedule (CKTSO_L_GpuGetSchedule): retrieves the dependency and level schedule analysis of a host accelerator
+* @accel: accelerator instance handle, initialized
+* @schedule: retrieves the summary
+* @width: long long array of length size, retrieves #columns of each level (up to size levels). Can be NULL
+* @flops: long long array of length size, retrieves #floating-point operations of each level (up to size levels). Can be NULL
+* @size: length of width and flops
+* returns 0, -2, -4, -52 (not initialized), or -55 for a GPU-accelerator
+*/
+int CKTSO_GpuGetSchedule
+(
+	_IN_ ICktSoGpu accel,
+	_OUT_ CKTSO_GPU_SCHEDULE *schedule,
+	_OUT_ long long width[],
+	_OUT_ long long flops[],
+	_IN_ long long size
+);
+
+int CKTSO_L_GpuGetSchedule
+(
+	_IN_ ICktSoGpu_L accel,
+	_OUT_ CKTSO_GPU_SCHEDULE *schedule,
+	_OUT_ long long width[],
+	_OUT_ long long flops[],
+	_IN_ long long size
+);
+
+/*
+* CKTSO_GpuDumpSchedule (CKTSO_L_GpuDumpSchedule): writes the dependency structure of a host accelerator
+* @accel: accelerator instance handle, initialized
+* @file: output file, NULL for the standard output
+* @format: 0: text report, the summary, the level width histogram, the bulk/pipeline cutover of several input parm[1] values,
+*   and the width and flops of each level | 1: Graphviz DOT of the column dependency graph, columns of a level ranked together,
+*   each labeled with its factor column and matrix row (row mode) | 2: edge list, one "from,to" line per dependency, for large graphs
+* returns 0, -2, -52 (not initialized), -55 for a GPU-accelerator, or -56 (file cannot be written)
+*/
+int CKTSO_GpuDumpSchedule
+(
+	_IN_ ICktSoGpu accel,
+	_IN_ const char file[],
+	_IN_ int format
+);
+
+int CKTSO_L_GpuDumpSchedule
+(
+	_IN_ ICktSoGpu_L accel,
+	_IN_ const char file[],
+	_IN_ int format
+);
+
+/*
+* CKTSO_ConvertTrace: converts a binary trace written by CKTSO(_L)_GpuDumpTrace to Chrome trace JSON
+* returns 0, -3 (invalid binary trace), -4, or -56 (file cannot be read or written)
+*/
+int CKTSO_ConvertTrace
+(
+	_IN_ const char binary[],
+	_IN_ const char json[]
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+struct __CKTSO_GPU_ASYNC
+{
+	virtual int _CDECL_ DestroyGpuAsync
+	(
+	) = 0;
+	virtual int _CDECL_ GpuRefactorizeAsync
+	(
+		_IN_ const double ax[],
+		_OUT_ ICktSoGpuRequest *req
+	) = 0;
+	virtual int _CDECL_ GpuSolveAsync
+	(
+		_IN_ const double b[],
+		_OUT_ double x[], /*x address can be same as b address*/
+		_IN_ bool row0_column1,
+		_OUT_ ICktSoGpuRequest *req
+	) = 0;
+};
+
+struct __CKTSO_GPU_REQUEST
+{
+	virtual int _CDECL_ Wait
+	(
+	) = 0;
+	virtual int _CDECL_ Test
+	(
+		_OUT_ bool *done
+	) = 0;
+};
+#endif
+
+#endif
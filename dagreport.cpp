@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "cktso.h"
+#include "cktso-bin.h"
+#include "cktso-gpu-host.h"
+
+//dependency and level schedule report of the host accelerator, offline: no refactor or solve is run
+
+struct Options
+{
+    const char *file;
+    const char *dot;
+    const char *edges;
+    int threshold;
+    int threads;
+};
+
+static void Usage()
+{
+    printf("Usage: dagreport [options] <matrix>\n");
+    printf("    matrix: Matrix Market (.mtx) or binary matrix file (compressed columns)\n");
+    printf("    -t <n>     bulk threshold, input parm[1] (default: accelerator default)\n");
+    printf("    -j <n>     #host accelerator threads, 0 for all hardware threads (default 0)\n");
+    printf("    -d <file>  writes the column dependency graph as Graphviz DOT\n");
+    printf("    -e <file>  writes the dependencies as a \"from,to\" edge list\n");
+    printf("The text report is printed to the standard output.\n");
+    printf("Example: dagreport -t 64 -d ckt.dot ckt.mtx && dot -Tsvg ckt.dot -o ckt.svg\n");
+}
+
+static bool Parse(int argc, char *argv[], Options &opt)
+{
+    opt.file = NULL;
+    opt.dot = NULL;
+    opt.edges = NULL;
+    opt.threshold = -1;
+    opt.threads = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *a = argv[i];
+        if ('-' == a[0] && a[1] != '\0' && '\0' == a[2])
+        {
+            if (i + 1 >= argc) return false;
+            const char *v = argv[++i];
+            switch (a[1])
+            {
+            case 't': opt.threshold = atoi(v); break;
+            case 'j': opt.threads = atoi(v); break;
+            case 'd': opt.dot = v; break;
+            case 'e': opt.edges = v; break;
+            default: return false;
+            }
+        }
+        else if (NULL == opt.file) opt.file = a;
+        else return false;
+    }
+    return opt.file != NULL;
+}
+
+static bool Load(const char file[], long long &n, std::vector<long long> &ap, std::vector<long long> &ai, std::vector<double> &ax, bool &is_complex)
+{
+    if (CKTSO_IsBinaryMatrix(file))
+    {
+        CKTSO_BIN_MATRIX bin;
+        const int ret = CKTSO_MapBinaryMatrix(file, &bin);
+        if (ret != 0 || (bin.header.flags & CKTSO_BIN_CSR))
+        {
+            printf("Cannot use binary file \"%s\" (return code = %d, CSR containers are not supported).\n", file, ret);
+            if (0 == ret) CKTSO_UnmapBinaryMatrix(&bin);
+            return false;
+        }
+        n = bin.header.n;
+        is_complex = (bin.header.flags & CKTSO_BIN_COMPLEX) != 0;
+        const long long nnz = bin.header.nnz;
+        if (bin.header.flags & CKTSO_BIN_INDEX64)
+        {
+            ap.assign((const long long *)bin.ap, (const long long *)bin.ap + n + 1);
+            ai.assign((const long long *)bin.ai, (const long long *)bin.ai + nnz);
+        }
+        else
+        {
+            ap.assign((const int *)bin.ap, (const int *)bin.ap + n + 1);
+            ai.assign((const int *)bin.ai, (const int *)bin.ai + nnz);
+        }
+        ax.assign(bin.ax, bin.ax + nnz * (is_complex ? 2 : 1));
+        CKTSO_UnmapBinaryMatrix(&bin);
+        return true;
+    }
+
+    long long *p = NULL, *i = NULL;
+    double *x = NULL;
+    const int ret = CKTSO_L_ReadMatrixMarket(file, &n, &p, &i, &x, &is_complex, false, 0);
+    if (ret != 0)
+    {
+        printf("Cannot read \"%s\", return code = %d.\n", file, ret);
+        return false;
+    }
+    ap.assign(p, p + n + 1);
+    ai.assign(i, i + p[n]);
+    ax.assign(x, x + p[n] * (is_complex ? 2 : 1));
+    CKTSO_FreeMatrix(p, i, x);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    Options opt;
+    if (!Parse(argc, argv, opt))
+    {
+        Usage();
+        return -1;
+    }
+
+    long long n;
+    std::vector<long long> ap, ai;
+    std::vector<double> ax;
+    bool is_complex;
+    if (!Load(opt.file, n, ap, ai, ax, is_complex)) return -1;
+
+    ICktSo_L inst = NULL;
+    ICktSoGpu_L accel = NULL;
+    int *iparm_cpu, *iparm;
+    const long long *oparm_cpu, *oparm;
+    int ret = CKTSO_L_CreateSolver(&inst, &iparm_cpu, &oparm_cpu);
+    if (0 == ret) ret = inst->Analyze(is_complex, n, &ap[0], &ai[0], &ax[0], 0);
+    if (0 == ret) ret = inst->Factorize(&ax[0], true);
+    if (0 == ret) ret = inst->SortFactors(true);
+    if (ret != 0)
+    {
+        printf("CPU solver failed, return code = %d.\n", ret);
+        if (inst != NULL) inst->DestroySolver();
+        return -1;
+    }
+
+    //the schedule is the host accelerator's own, so it is created whether a gpu is present or not
+    ret = CKTSO_L_CreateHostAccelerator(&accel, &iparm, &oparm, opt.threads);
+    if (0 == ret)
+    {
+        if (opt.threshold > 0) iparm[1] = opt.threshold;
+        ret = CKTSO_L_SetHostMatrix(accel, is_complex, n, &ap[0], &ai[0], &ax[0]);
+    }
+    if (0 == ret) ret = accel->InitializeGpuAccelerator(inst);
+    if (ret != 0) printf("Failed to initialize host accelerator, return code = %d.\n", ret);
+
+    if (0 == ret)
+    {
+        printf("%s: %s, n = %lld, nnz = %lld, input parm[1] = %d\n\n", opt.file, is_complex ? "complex" : "real", n, ap[n], iparm[1]);
+        ret = CKTSO_L_GpuDumpSchedule(accel, NULL, 0);
+        if (0 == ret && opt.dot != NULL) ret = CKTSO_L_GpuDumpSchedule(accel, opt.dot, 1);
+        if (0 == ret && opt.edges != NULL) ret = CKTSO_L_GpuDumpSchedule(accel, opt.edges, 2);
+        if (ret != 0) printf("Failed to write the schedule, return code = %d.\n", ret);
+    }
+
+    if (accel != NULL) accel->DestroyGpuAccelerator();
+    inst->DestroySolver();
+    return 0 == ret ? 0 : -1;
+}
@@ -3,6 +3,7 @@
 #include <string.h>
 #include <math.h>
 #include "cktso.h"
+#include "cktso-bin.h"
 #include "cktso-gpu.h"
 
 bool ReadMtxFile(const char file[], int &n, int *&ap, int *&ai, double *&ax)
@@ -79,6 +80,29 @@ bool ReadMtxFile(const char file[], int &n, int *&ap, int *&ai, double *&ax)
     return true;
 }
 
+bool MapBinFile(const char file[], CKTSO_BIN_MATRIX &bin, int &n, int *&ap, int *&ai, double *&ax)
+{
+    const int ret = CKTSO_MapBinaryMatrix(file, &bin);
+    if (ret != 0)
+    {
+        printf("Cannot map binary file \"%s\", return code = %d.\n", file, ret);
+        return false;
+    }
+    if (bin.header.flags & (CKTSO_BIN_INDEX64 | CKTSO_BIN_COMPLEX | CKTSO_BIN_CSR))
+    {
+        printf("Binary file \"%s\" is not a real CSC matrix with int indexes.\n", file);
+        CKTSO_UnmapBinaryMatrix(&bin);
+        return false;
+    }
+
+    //arrays are used in place, no parsing or copying
+    n = (int)bin.header.n;
+    ap = (int *)bin.ap;
+    ai = (int *)bin.ai;
+    ax = bin.ax;
+    return true;
+}
+
 double L2NormOfResidual(const int n, const int ap[], const int ai[], const double ax[], const double x[], const double b[], bool row0_col1)
 {
     if (row0_col1)
@@ -127,7 +151,7 @@ int main(int argc, char *argv[])
 {
     if (argc < 2)
     {
-        printf("Usage: demo <mtx file>\n");
+        printf("Usage: demo <mtx or binary file>\n");
         printf("Example: demo add20.mtx\n");
         return -1;
     }
@@ -137,6 +161,7 @@ int main(int argc, char *argv[])
     int *ap = NULL;
     int *ai = NULL;
     double *ax = NULL;
+    CKTSO_BIN_MATRIX bin;
     ICktSo inst_cpu = NULL;
     ICktSoGpu inst_gpu = NULL;
     int *iparm_cpu, *iparm_gpu;
@@ -144,7 +169,12 @@ int main(int argc, char *argv[])
     double *b = NULL;
     double *x = NULL;
 
-    if (!ReadMtxFile(argv[1], n, ap, ai, ax)) goto EXIT;
+    memset(&bin, 0, sizeof(bin));
+    if (CKTSO_IsBinaryMatrix(argv[1]))
+    {
+        if (!MapBinFile(argv[1], bin, n, ap, ai, ax)) goto EXIT;
+    }
+    else if (!ReadMtxFile(argv[1], n, ap, ai, ax)) goto EXIT;
 
     b = new double [n + n];
     x = b + n;
@@ -237,9 +267,16 @@ int main(int argc, char *argv[])
     printf("Residual = %g.\n", L2NormOfResidual(n, ap, ai, ax, x, b, true));
 
 EXIT:
-    delete []ap;
-    delete []ai;
-    delete []ax;
+    if (bin.base != NULL)
+    {
+        CKTSO_UnmapBinaryMatrix(&bin);
+    }
+    else
+    {
+        delete []ap;
+        delete []ai;
+        delete []ax;
+    }
     delete []b;
     inst_cpu->DestroySolver();
     inst_gpu->DestroyGpuAccelerator();
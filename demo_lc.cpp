@@ -3,6 +3,7 @@
 #include <string.h>
 #include <math.h>
 #include "cktso.h"
+#include "cktso-bin.h"
 #include "cktso-gpu.h"
 
 bool ReadMtxFile(const char file[], long long &n, long long *&ap, long long *&ai, double *&ax)
@@ -90,6 +91,29 @@ typedef double complex[2];
     (z)[1] = a0 * b1 + a1 * b0; \
 }
 
+bool MapBinFile(const char file[], CKTSO_BIN_MATRIX &bin, long long &n, long long *&ap, long long *&ai, double *&ax)
+{
+    const int ret = CKTSO_MapBinaryMatrix(file, &bin);
+    if (ret != 0)
+    {
+        printf("Cannot map binary file \"%s\", return code = %d.\n", file, ret);
+        return false;
+    }
+    if (!(bin.header.flags & CKTSO_BIN_INDEX64) || (bin.header.flags & CKTSO_BIN_CSR))
+    {
+        printf("Binary file \"%s\" is not a complex or real CSC matrix with long long indexes.\n", file);
+        CKTSO_UnmapBinaryMatrix(&bin);
+        return false;
+    }
+
+    //arrays are used in place, no parsing or copying
+    n = (long long)bin.header.n;
+    ap = (long long *)bin.ap;
+    ai = (long long *)bin.ai;
+    ax = bin.ax;
+    return true;
+}
+
 double L2NormOfResidual(const long long n, const long long ap[], const long long ai[], const complex ax[], const complex x[], const complex b[], bool row0_col1)
 {
     if (row0_col1)
@@ -147,7 +171,7 @@ int main(int argc, char *argv[])
 {
     if (argc < 2)
     {
-        printf("Usage: demo_lc <mtx file>\n");
+        printf("Usage: demo_lc <mtx or binary file>\n");
         printf("Example: demo_lc add20.mtx\n");
         return -1;
     }
@@ -157,6 +181,7 @@ int main(int argc, char *argv[])
     long long *ap = NULL;
     long long *ai = NULL;
     double *ax = NULL;
+    CKTSO_BIN_MATRIX bin;
     double *cx = NULL;
     ICktSo_L inst_cpu = NULL;
     ICktSoGpu_L inst_gpu = NULL;
@@ -165,22 +190,35 @@ int main(int argc, char *argv[])
     double *b = NULL;
     double *x = NULL;
 
-    if (!ReadMtxFile(argv[1], n, ap, ai, ax)) goto EXIT;
+    memset(&bin, 0, sizeof(bin));
+    if (CKTSO_IsBinaryMatrix(argv[1]))
+    {
+        if (!MapBinFile(argv[1], bin, n, ap, ai, ax)) goto EXIT;
+    }
+    else if (!ReadMtxFile(argv[1], n, ap, ai, ax)) goto EXIT;
 
     nnz = ap[n];
-    cx = new double [nnz * 2];
-    if (NULL == cx)
+    if (bin.header.flags & CKTSO_BIN_COMPLEX)
     {
-        printf("Malloc for cx failed.\n");
-        goto EXIT;
+        cx = ax;//complex container, used in place
+        ax = NULL;
     }
-    for (long long i = 0; i < nnz; ++i)
+    else
     {
-        cx[i + i] = ax[i];
-        cx[i + i + 1] = ax[i] * ((double)rand() / RAND_MAX - .5) * 2.;//randomly generate imaginary parts
+        cx = new double [nnz * 2];
+        if (NULL == cx)
+        {
+            printf("Malloc for cx failed.\n");
+            goto EXIT;
+        }
+        for (long long i = 0; i < nnz; ++i)
+        {
+            cx[i + i] = ax[i];
+            cx[i + i + 1] = ax[i] * ((double)rand() / RAND_MAX - .5) * 2.;//randomly generate imaginary parts
+        }
+        if (NULL == bin.base) delete[]ax;
+        ax = NULL;
     }
-    delete[]ax;
-    ax = NULL;
 
     b = new double [n * 4];
     x = b + n * 2;
@@ -279,9 +317,17 @@ int main(int argc, char *argv[])
     printf("Residual = %g.\n", L2NormOfResidual(n, ap, ai, (complex *)cx, (complex *)x, (complex *)b, true));
 
 EXIT:
-    delete []ap;
-    delete []ai;
-    delete []ax;
+    if (bin.base != NULL)
+    {
+        CKTSO_UnmapBinaryMatrix(&bin);
+        if (bin.header.flags & CKTSO_BIN_COMPLEX) cx = NULL;
+    }
+    else
+    {
+        delete []ap;
+        delete []ai;
+        delete []ax;
+    }
     delete []cx;
     delete []b;
     inst_cpu->DestroySolver();
@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <string.h>
+#include "cktso-gpu-host.h"
+#include "cktso-bin.h"
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        printf("Usage: mtx2bin <mtx file> <binary file> [-l] [-r]\n");
+        printf("    -l: long long indexes, for the _L routines (default int)\n");
+        printf("    -r: compressed rows (default compressed columns, as the demos read .mtx files)\n");
+        printf("Example: mtx2bin add20.mtx add20.bin\n");
+        return -1;
+    }
+
+    bool index64 = false, csr = false;
+    for (int i = 3; i < argc; ++i)
+    {
+        if (0 == strcmp(argv[i], "-l")) index64 = true;
+        else if (0 == strcmp(argv[i], "-r")) csr = true;
+    }
+
+    int ret;
+    bool is_complex;
+    void *ap = NULL;
+    void *ai = NULL;
+    double *ax = NULL;
+    long long n;
+    if (index64)
+    {
+        ret = CKTSO_L_ReadMatrixMarket(argv[1], &n, (long long **)&ap, (long long **)&ai, &ax, &is_complex, csr, 0);
+    }
+    else
+    {
+        int n32;
+        ret = CKTSO_ReadMatrixMarket(argv[1], &n32, (int **)&ap, (int **)&ai, &ax, &is_complex, csr, 0);
+        n = n32;
+    }
+    if (ret != 0)
+    {
+        printf("Failed to read \"%s\", return code = %d.\n", argv[1], ret);
+        return -1;
+    }
+
+    ret = CKTSO_WriteBinaryMatrix(argv[2], index64, is_complex, csr, n, ap, ai, ax);
+    const long long nnz = index64 ? ((long long *)ap)[n] : ((int *)ap)[n];
+    CKTSO_FreeMatrix(ap, ai, ax);
+    if (ret != 0)
+    {
+        printf("Failed to write \"%s\", return code = %d.\n", argv[2], ret);
+        return -1;
+    }
+    printf("n = %lld, nnz = %lld, %s, %s indexes, %s.\n", n, nnz, is_complex ? "complex" : "real", index64 ? "long long" : "int", csr ? "CSR" : "CSC");
+    return 0;
+}
@@ -0,0 +1,475 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "cktso-bin.h"
+
+//generator of circuit-like sparse matrices, deterministic by seed, see Usage() for options
+
+//splitmix64, the same sequence on every platform
+class Rng
+{
+public:
+    explicit Rng(unsigned long long seed) : s_(seed) {}
+    unsigned long long Next()
+    {
+        unsigned long long z = (s_ += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    //[0, 1)
+    double Uniform()
+    {
+        return (double)(Next() >> 11) * (1. / 9007199254740992.);
+    }
+    //[0, k)
+    long long Below(long long k)
+    {
+        return (long long)(Next() % (unsigned long long)k);
+    }
+    //log-uniform in [10^lo, 10^hi), from a table so that no libm call makes the values platform dependent
+    double Decades(int lo, int hi)
+    {
+        static const double pow10[] = { 1e-6, 1e-5, 1e-4, 1e-3, 1e-2, 1e-1, 1., 1e1, 1e2, 1e3, 1e4, 1e5, 1e6 };
+        const int e = lo + (int)Below(hi - lo);
+        return (1. + 9. * Uniform()) * pow10[e + 6];
+    }
+
+private:
+    unsigned long long s_;
+};
+
+//two-terminal element between nodes a and b, of conductance g and capacitive admittance c
+struct Element
+{
+    long long a, b;
+    double g, c;
+};
+
+//voltage-controlled current source, gm * (v[ctrl] - v[s]) flowing from d to s, s < 0 for ground
+struct Vccs
+{
+    long long d, s, ctrl;
+    double gm;
+};
+
+/*
+* Netlist: modified nodal analysis of G and C stamps
+* Node unknowns come first, then one branch current per voltage source (node to ground), whose row and column have no diagonal
+* The real matrix is the transient companion G + C (C already scaled by 1/h), the complex one is G + jC (C scaled by omega)
+*/
+struct Netlist
+{
+    long long nodes;
+    std::vector<double> gg, gc; //to ground
+    std::vector<Element> el;
+    std::vector<Vccs> vccs;
+    std::vector<long long> vsrc;
+
+    Netlist() : nodes(0) {}
+
+    long long AddNodes(long long k)
+    {
+        const long long first = nodes;
+        nodes += k;
+        gg.resize(nodes, 1e-9); //gmin
+        gc.resize(nodes, 0.);
+        return first;
+    }
+    void Connect(long long a, long long b, double g, double c)
+    {
+        if (a == b) return;
+        Element e = { a, b, g, c };
+        el.push_back(e);
+    }
+    void Ground(long long a, double g, double c)
+    {
+        gg[a] += g;
+        gc[a] += c;
+    }
+    long long Unknowns() const
+    {
+        return nodes + (long long)vsrc.size();
+    }
+};
+
+/*
+* builders, each adds nodes to the netlist and returns the first one
+*/
+
+//RC ladder: series resistors, a capacitor to ground at every node, a driver conductance at the first node
+static long long Ladder(Netlist &net, Rng &rng, long long len)
+{
+    const long long first = net.AddNodes(len);
+    net.Ground(first, rng.Decades(-1, 1), 0.);
+    for (long long i = 0; i < len; ++i)
+    {
+        net.Ground(first + i, 0., rng.Decades(-3, -1));
+        if (i > 0) net.Connect(first + i - 1, first + i, rng.Decades(0, 2), 0.);
+    }
+    return first;
+}
+
+//power-grid mesh of k x k nodes: resistive segments to the right and down neighbours, decoupling capacitance and a load at every node
+static long long Grid(Netlist &net, Rng &rng, long long k)
+{
+    const long long first = net.AddNodes(k * k);
+    for (long long r = 0; r < k; ++r)
+    {
+        for (long long c = 0; c < k; ++c)
+        {
+            const long long v = first + r * k + c;
+            net.Ground(v, rng.Decades(-4, -2), rng.Decades(-3, -1));
+            if (c + 1 < k) net.Connect(v, v + 1, rng.Decades(1, 3), 0.);
+            if (r + 1 < k) net.Connect(v, v + k, rng.Decades(1, 3), 0.);
+        }
+    }
+    return first;
+}
+
+//subcircuit of size nodes: a resistive chain, random internal resistors and capacitors, and transconductances as transistors stamp them
+static long long Subcircuit(Netlist &net, Rng &rng, long long size)
+{
+    const long long first = net.AddNodes(size);
+    for (long long i = 0; i < size; ++i)
+    {
+        const long long v = first + i;
+        net.Ground(v, 0., rng.Decades(-4, -2));
+        if (i > 0) net.Connect(v - 1, v, rng.Decades(-2, 1), 0.);
+        net.Connect(v, first + rng.Below(size), rng.Decades(-3, 0), rng.Decades(-4, -2));
+        if (size >= 3 && rng.Uniform() < .5)
+        {
+            Vccs t = { v, first + rng.Below(size), first + rng.Below(size), rng.Decades(-4, -1) };
+            if (t.s == t.d) t.s = -1;
+            net.vccs.push_back(t);
+        }
+    }
+    return first;
+}
+
+//bordered-block structure: subcircuits of size block whose ports connect to shared border nets
+static long long Bordered(Netlist &net, Rng &rng, long long nodes, long long block)
+{
+    const long long blocks = std::max(1LL, nodes / (block + 1));
+    const long long border = net.AddNodes(std::max(1LL, blocks / 2));
+    const long long nets = net.nodes - border;
+    for (long long i = 0; i < nets; ++i) net.Ground(border + i, 0., rng.Decades(-3, -1));
+    for (long long b = 0; b < blocks; ++b)
+    {
+        const long long first = Subcircuit(net, rng, block);
+        for (int p = 0; p < 4; ++p)
+        {
+            net.Connect(first + rng.Below(block), border + rng.Below(nets), rng.Decades(-1, 2), 0.);
+        }
+    }
+    return border;
+}
+
+//dense-ish coupling: a capacitor between every two of size random nodes in [first, first + range)
+static void Coupling(Netlist &net, Rng &rng, long long first, long long range, int size)
+{
+    std::vector<long long> v(size);
+    for (int i = 0; i < size; ++i) v[i] = first + rng.Below(range);
+    for (int i = 0; i < size; ++i)
+    {
+        for (int j = i + 1; j < size; ++j) net.Connect(v[i], v[j], 0., rng.Decades(-5, -3));
+    }
+}
+
+//voltage sources from distinct nodes of [first, first + range) to ground, one per segment of the range
+static void Sources(Netlist &net, Rng &rng, long long first, long long range, long long count)
+{
+    count = std::min(count, range);
+    const long long seg = range / std::max(1LL, count);
+    for (long long i = 0; i < count; ++i) net.vsrc.push_back(first + i * seg + rng.Below(seg));
+}
+
+/*
+* Assemble: compressed columns of the file (rows if by_row), sorted, duplicates summed
+* ax holds (complex ? 2 : 1) doubles per entry
+*/
+struct Entry
+{
+    long long row;
+    double re, im;
+};
+
+static void Assemble(const Netlist &net, bool complex, bool by_row, std::vector<long long> &ap, std::vector<long long> &ai, std::vector<double> &ax)
+{
+    const long long n = net.Unknowns();
+    ap.assign(n + 1, 0);
+
+    //diagonals are summed apart, pass 0 counts the other entries per column and pass 1 places them
+    std::vector<double> dre(net.gg), dim(net.gc);
+    std::vector<Entry> e;
+    std::vector<long long> pos;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        auto add = [&](long long r, long long c, double re, double im)
+        {
+            if (r == c)
+            {
+                if (pass != 0) return;
+                dre[r] += re;
+                dim[r] += im;
+                return;
+            }
+            if (by_row) std::swap(r, c);
+            if (0 == pass) ++ap[c + 1];
+            else
+            {
+                Entry &t = e[pos[c]++];
+                t.row = r;
+                t.re = re;
+                t.im = im;
+            }
+        };
+        for (size_t k = 0; k < net.el.size(); ++k)
+        {
+            const Element &x = net.el[k];
+            add(x.a, x.a, x.g, x.c);
+            add(x.b, x.b, x.g, x.c);
+            add(x.a, x.b, -x.g, -x.c);
+            add(x.b, x.a, -x.g, -x.c);
+        }
+        for (size_t k = 0; k < net.vccs.size(); ++k)
+        {
+            const Vccs &x = net.vccs[k];
+            add(x.d, x.ctrl, x.gm, 0.);
+            if (x.s >= 0)
+            {
+                add(x.d, x.s, -x.gm, 0.);
+                add(x.s, x.ctrl, -x.gm, 0.);
+                add(x.s, x.s, x.gm, 0.);
+            }
+        }
+        for (size_t k = 0; k < net.vsrc.size(); ++k)
+        {
+            const long long m = net.nodes + (long long)k;
+            add(net.vsrc[k], m, 1., 0.);
+            add(m, net.vsrc[k], 1., 0.);
+        }
+        if (0 == pass)
+        {
+            for (long long i = 0; i < net.nodes; ++i) ++ap[i + 1];
+            for (long long j = 0; j < n; ++j) ap[j + 1] += ap[j];
+            e.resize(ap[n]);
+            pos.assign(ap.begin(), ap.end() - 1);
+            for (long long i = 0; i < net.nodes; ++i) e[pos[i]++].row = i;
+        }
+        else
+        {
+            for (long long i = 0; i < net.nodes; ++i)
+            {
+                e[ap[i]].re = dre[i];
+                e[ap[i]].im = dim[i];
+            }
+        }
+    }
+    pos.clear();
+    pos.shrink_to_fit();
+    dre.clear();
+    dre.shrink_to_fit();
+    dim.clear();
+    dim.shrink_to_fit();
+
+    //each column sorted and merged in place, then compacted
+    long long nnz = 0;
+    for (long long j = 0; j < n; ++j)
+    {
+        Entry *b = &e[0] + ap[j], *end = &e[0] + ap[j + 1];
+        std::sort(b, end, [](const Entry &x, const Entry &y) { return x.row < y.row; });
+        ap[j] = nnz;
+        for (Entry *p = b; p < end; ++p)
+        {
+            if (nnz > ap[j] && e[nnz - 1].row == p->row)
+            {
+                e[nnz - 1].re += p->re;
+                e[nnz - 1].im += p->im;
+            }
+            else e[nnz++] = *p;
+        }
+    }
+    ap[n] = nnz;
+
+    const int scalar = complex ? 2 : 1;
+    ai.resize(nnz);
+    ax.resize(nnz * scalar);
+    for (long long p = 0; p < nnz; ++p)
+    {
+        ai[p] = e[p].row;
+        if (complex)
+        {
+            ax[2 * p] = e[p].re;
+            ax[2 * p + 1] = e[p].im;
+        }
+        else ax[p] = e[p].re + e[p].im;
+    }
+}
+
+//Matrix Market, from compressed columns of the file
+static bool WriteMtx(const char file[], bool complex, long long n, const std::vector<long long> &ap, const std::vector<long long> &ai, const std::vector<double> &ax)
+{
+    FILE *fp = fopen(file, "w");
+    if (NULL == fp) return false;
+    bool ok = fprintf(fp, "%%%%MatrixMarket matrix coordinate %s general\n%lld %lld %lld\n", complex ? "complex" : "real", n, n, ap[n]) > 0;
+    std::vector<char> buf(1 << 20);
+    size_t len = 0;
+    for (long long j = 0; j < n && ok; ++j)
+    {
+        for (long long p = ap[j]; p < ap[j + 1] && ok; ++p)
+        {
+            if (len + 128 > buf.size())
+            {
+                ok = fwrite(&buf[0], 1, len, fp) == len;
+                len = 0;
+            }
+            if (complex) len += snprintf(&buf[len], 128, "%lld %lld %.15g %.15g\n", ai[p] + 1, j + 1, ax[2 * p], ax[2 * p + 1]);
+            else len += snprintf(&buf[len], 128, "%lld %lld %.15g\n", ai[p] + 1, j + 1, ax[p]);
+        }
+    }
+    ok = ok && fwrite(&buf[0], 1, len, fp) == len;
+    ok = (fclose(fp) == 0) && ok;
+    return ok;
+}
+
+static void Usage()
+{
+    printf("Usage: mtxgen <output file> [options]\n");
+    printf("    .mtx files are written as Matrix Market, other names as binary containers\n");
+    printf("    -t <type>: ladder, grid, bbd (bordered blocks) or mixed (default)\n");
+    printf("    -n <nodes>: approximate #circuit nodes (default 100000), voltage source branches are added\n");
+    printf("    -s <seed>: random seed (default 1), the same seed gives the same matrix\n");
+    printf("    -b <size>: subcircuit size of bbd and mixed (default 64)\n");
+    printf("    -d <size>: dense coupling block size (default 0, 16 for mixed)\n");
+    printf("    -k <count>: #coupling blocks (default nodes / 1000)\n");
+    printf("    -v <count>: #voltage sources (default nodes / 1000 + 1)\n");
+    printf("    -c: complex G + jC (default real G + C)\n");
+    printf("    -l: long long indexes in the binary container (default int)\n");
+    printf("    -r: compressed rows in the binary container (default compressed columns)\n");
+    printf("Example: mtxgen grid1m.bin -t grid -n 1000000 -s 7\n");
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || '-' == argv[1][0])
+    {
+        Usage();
+        return -1;
+    }
+
+    std::string type = "mixed";
+    long long nodes = 100000, couplings = -1, sources = -1;
+    unsigned long long seed = 1;
+    long long block = 64;
+    int dense = -1;
+    bool complex = false, index64 = false, csr = false;
+    for (int i = 2; i < argc; ++i)
+    {
+        const char *a = argv[i];
+        const bool has = i + 1 < argc;
+        if (0 == strcmp(a, "-t") && has) type = argv[++i];
+        else if (0 == strcmp(a, "-n") && has) nodes = atoll(argv[++i]);
+        else if (0 == strcmp(a, "-s") && has) seed = strtoull(argv[++i], NULL, 10);
+        else if (0 == strcmp(a, "-b") && has) block = atoll(argv[++i]);
+        else if (0 == strcmp(a, "-d") && has) dense = atoi(argv[++i]);
+        else if (0 == strcmp(a, "-k") && has) couplings = atoll(argv[++i]);
+        else if (0 == strcmp(a, "-v") && has) sources = atoll(argv[++i]);
+        else if (0 == strcmp(a, "-c")) complex = true;
+        else if (0 == strcmp(a, "-l")) index64 = true;
+        else if (0 == strcmp(a, "-r")) csr = true;
+        else
+        {
+            Usage();
+            return -1;
+        }
+    }
+    if (nodes < 4 || block < 2 || (type != "ladder" && type != "grid" && type != "bbd" && type != "mixed"))
+    {
+        Usage();
+        return -1;
+    }
+    if (dense < 0) dense = type == "mixed" ? 16 : 0;
+    if (couplings < 0) couplings = nodes / 1000;
+    if (sources < 0) sources = nodes / 1000 + 1;
+
+    Netlist net;
+    Rng rng(seed);
+    if (type == "ladder") Ladder(net, rng, nodes);
+    else if (type == "grid") Grid(net, rng, std::max(2LL, (long long)sqrt((double)nodes)));
+    else if (type == "bbd") Bordered(net, rng, nodes, block);
+    else
+    {
+        //a supply grid (sources on its pads), RC interconnect ladders and subcircuits tapping the grid
+        const long long k = std::max(2LL, (long long)sqrt(.3 * nodes));
+        const long long grid = Grid(net, rng, k);
+        const long long ladders = std::max(1LL, nodes / 5000);
+        for (long long i = 0; i < ladders; ++i)
+        {
+            const long long first = Ladder(net, rng, std::max(2LL, nodes / 5 / ladders));
+            net.Connect(first, grid + rng.Below(k * k), rng.Decades(0, 2), 0.);
+        }
+        const long long before = net.nodes;
+        Bordered(net, rng, nodes - before, block);
+        for (long long i = 0; i < (net.nodes - before) / block; ++i)
+        {
+            net.Connect(before + rng.Below(net.nodes - before), grid + rng.Below(k * k), rng.Decades(0, 2), 0.);
+        }
+        Sources(net, rng, grid, k * k, sources);
+    }
+    if (type != "mixed") Sources(net, rng, 0, net.nodes, sources);
+    for (long long i = 0; i < couplings && dense >= 2; ++i)
+    {
+        const long long range = std::min(net.nodes, (long long)dense * 64);
+        Coupling(net, rng, rng.Below(net.nodes - range + 1), range, dense);
+    }
+
+    const std::string file = argv[1];
+    const bool mtx = file.size() >= 4 && 0 == file.compare(file.size() - 4, 4, ".mtx");
+    if (mtx && csr)
+    {
+        printf("-r ignored for Matrix Market output.\n");
+        csr = false;
+    }
+
+    std::vector<long long> ap, ai;
+    std::vector<double> ax;
+    Assemble(net, complex, csr, ap, ai, ax);
+    net = Netlist();
+    const long long n = (long long)ap.size() - 1;
+    const long long nnz = ap[n];
+
+    int ret = 0;
+    if (mtx)
+    {
+        ret = WriteMtx(argv[1], complex, n, ap, ai, ax) ? 0 : -56;
+    }
+    else if (index64) ret = CKTSO_WriteBinaryMatrix(argv[1], true, complex, csr, n, &ap[0], &ai[0], &ax[0]);
+    else if (n >= INT_MAX || nnz >= INT_MAX)
+    {
+        printf("n = %lld, nnz = %lld do not fit int indexes, use -l.\n", n, nnz);
+        return -1;
+    }
+    else
+    {
+        std::vector<int> ap32(ap.begin(), ap.end());
+        ap.clear();
+        ap.shrink_to_fit();
+        std::vector<int> ai32(ai.begin(), ai.end());
+        ai.clear();
+        ai.shrink_to_fit();
+        ret = CKTSO_WriteBinaryMatrix(argv[1], false, complex, csr, n, &ap32[0], &ai32[0], &ax[0]);
+    }
+    if (ret != 0)
+    {
+        printf("Failed to write \"%s\", return code = %d.\n", argv[1], ret);
+        return -1;
+    }
+    printf("%s: n = %lld, nnz = %lld (%.2f per row), %s, seed %llu.\n", type.c_str(), n, nnz, (double)nnz / n, complex ? "complex" : "real", seed);
+    return 0;
+}
@@ -0,0 +1,1599 @@
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+#include <mutex>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_accel.h"
+#include "host_dispatch.h"
+
+namespace cktso_host
+{
+
+template <typename Base, typename Inst, typename Index>
+HostAccelerator<Base, Inst, Index>::HostAccelerator(int threads) :
+    pool_(threads), complex_(false), fsize_(0), batch_(1), single_(false), stale_(false), nextplan_(0), threshold_(0), ordering_(ORDER_AMD), initialized_(false), tracing_(NULL)
+{
+    memset(iparm, 0, sizeof(iparm));
+    memset(oparm, 0, sizeof(oparm));
+    iparm[1] = 128;
+    iparm[2] = 110;
+    iparm[8] = 1;
+    iparm[12] = 12;
+    iparm[13] = 1;
+    const char *env = getenv("CKTSO_GPU_HOST_CACHE");
+    if (env != NULL) cache_ = env;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::DestroyGpuAccelerator()
+{
+    delete this;
+    return 0;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::Threads(int parm) const
+{
+    const int t = pool_.Threads();
+    return (parm <= 0 || parm > t) ? t : parm;
+}
+
+/*follows iparm[14] at the beginning of each call, the ring is reallocated, hence emptied, when its capacity changes*/
+template <typename Base, typename Inst, typename Index>
+Tracer *HostAccelerator<Base, Inst, Index>::Trace()
+{
+    tracing_ = NULL;
+    if (iparm[14] > 0)
+    {
+        if (!trace_ || trace_->Capacity() != (size_t)iparm[14])
+        {
+            trace_.reset();
+            try
+            {
+                trace_.reset(new Tracer((size_t)iparm[14]));
+            }
+            catch (const std::bad_alloc &)
+            {
+            }
+        }
+        tracing_ = trace_.get();
+    }
+    lu_.SetTrace(tracing_);
+    return tracing_;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::DumpTrace(const char file[], bool binary, bool clear)
+{
+    if (!trace_) return -52;
+    int ret;
+    try
+    {
+        ret = trace_->Dump(file, binary);
+    }
+    catch (const std::bad_alloc &)
+    {
+        return -4;
+    }
+    if (0 == ret && clear) trace_->Reset();
+    return ret;
+}
+
+template <typename Base, typename Inst, typename Index>
+void HostAccelerator<Base, Inst, Index>::Memory()
+{
+    const Symbolic &s = lu_.Sym();
+    const long long factors = (long long)(factors_.capacity() * sizeof(double) + sfactors_.capacity() * sizeof(float)
+        + (s.cp.capacity() + s.ci.capacity() + s.dpos.capacity() + s.amap.capacity()) * sizeof(idx_t));
+    const long long all = (long long)(s.Bytes() + (ap_.capacity() + ai_.capacity()) * sizeof(idx_t)
+        + (ax_.capacity() + factors_.capacity() + work_.capacity() + swork_.capacity() + mwork_.capacity() + values_.capacity() + rwork_.capacity()
+        + ywork_.capacity() + sweep_.capacity() + fx_.capacity()) * sizeof(double)
+        + sfactors_.capacity() * sizeof(float)
+        + (rows_.rp.capacity() + rows_.ri.capacity() + rows_.rdiag.capacity() + stamps_.Capacity()) * sizeof(idx_t)
+        + dirty_.capacity() + mark_.capacity());
+    oparm[3] = all - factors;
+    oparm[4] = factors;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::SetMatrix(bool is_complex, Index n, const Index ap[], const Index ai[], const double ax[])
+{
+    if (n <= 0 || NULL == ap || NULL == ai || NULL == ax) return -2;
+    const idx_t nnz = (idx_t)ap[n];
+    if (nnz < 0) return -3;
+    TraceSpan span(Trace(), "stage matrix");
+    StatScope stat(stats_, CKTSO_STATS_SET_MATRIX);
+    stats_.In((long long)((n + 1 + nnz) * sizeof(Index) + nnz * (is_complex ? 2 : 1) * sizeof(double)));
+    try
+    {
+        oparm[5] = (long long)((n + 1 + nnz) * sizeof(idx_t) + nnz * (is_complex ? 2 : 1) * sizeof(double));
+        ap_.assign(ap, ap + n + 1);
+        ai_.assign(ai, ai + nnz);
+        ax_.assign(ax, ax + nnz * (is_complex ? 2 : 1));
+        oparm[5] = 0;
+    }
+    catch (const std::bad_alloc &)
+    {
+        return -4;
+    }
+    complex_ = is_complex;
+    return 0;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::SetCache(const char dir[])
+{
+    try
+    {
+        cache_ = NULL == dir ? std::string() : std::string(dir);
+    }
+    catch (const std::bad_alloc &)
+    {
+        return -4;
+    }
+    while (cache_.size() > 1 && ('/' == cache_.back() || '\\' == cache_.back())) cache_.pop_back();
+    return 0;
+}
+
+/*
+* Analyze: ordering, pivoting and symbolic structure
+* When the pattern and ordering (iparm[18]) are those of the current structure (and iparm[13] is set), only the trailing columns whose pivots fail
+* with the new values are pivoted again. Otherwise the structure is restored from the cache directory when the pattern was
+* saved before. A restored pivot sequence is kept only when the factors of the current values meet the pivoting tolerance,
+* otherwise the matrix is factorized again and the cache file is replaced. work_ must be allocated
+* @incremental: retrieves whether the ordering of the current structure was kept
+*/
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::Analyze(std::vector<double> &lu, bool again, bool &incremental)
+{
+    const idx_t n = (idx_t)ap_.size() - 1;
+    const idx_t *ap = &ap_[0];
+    const idx_t *ai = ai_.empty() ? NULL : &ai_[0];
+    const double *ax = ax_.empty() ? NULL : &ax_[0];
+    const Symbolic &s = lu_.Sym();
+    const int ordering = 1 == iparm[18] ? ORDER_RCM : ORDER_AMD;
+    std::string file;
+    oparm[16] = 0;
+    oparm[17] = (long long)n;
+    incremental = false;
+    if (!cache_.empty())
+    {
+        char name[48];
+        snprintf(name, sizeof(name), "/cktso-%016llx%s.sym", PatternHash(n, ap, ai), ORDER_RCM == ordering ? "-rcm" : "");
+        file = cache_ + name;
+    }
+
+    if (again && iparm[13] != 0 && ordering == ordering_ && s.complex == complex_ && s.ap == ap_ && s.ai == ai_)
+    {
+        TraceSpan span(tracing_, "repivot");
+        incremental = true;
+        idx_t repivoted = 0;
+        const int ret = lu_.Repivot(ax, HOST_PIVOT_TOL, lu, &work_[0], pool_, Threads(iparm[5]), repivoted);
+        if (ret != 0) return ret;
+        oparm[17] = (long long)repivoted;
+        lu_.Schedule(threshold_);
+        if (repivoted > 0 && !file.empty()) lu_.Save(file.c_str());
+        return 0;
+    }
+
+    if (!file.empty())
+    {
+        TraceSpan span(tracing_, "cache restore");
+        if (lu_.Load(file.c_str(), complex_, n, ap, ai))
+        {
+            lu_.Schedule(threshold_);
+            oparm[5] = (long long)((size_t)lu_.Sym().FactorNnz() * Scalar() * sizeof(double));
+            lu.resize((size_t)lu_.Sym().FactorNnz() * Scalar());
+            oparm[5] = 0;
+            if (0 == lu_.Refactorize(ax, &lu[0], &work_[0], pool_, Threads(iparm[5])) && lu_.FirstBadPivot(&lu[0], HOST_PIVOT_TOL) == n)
+            {
+                ordering_ = ordering;
+                oparm[16] = 1;
+                return 0;
+            }
+        }
+    }
+
+    TraceSpan span(tracing_, "factorize");
+    const int ret = lu_.Factorize(complex_, n, ap, ai, ax, HOST_PIVOT_TOL, ordering, lu);
+    if (ret != 0) return ret;
+    ordering_ = ordering;
+    lu_.Schedule(threshold_);
+    if (!file.empty()) lu_.Save(file.c_str());
+    return 0;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::InitializeGpuAccelerator(Inst inst)
+{
+    if (NULL == inst) return -1;
+    if (ap_.empty()) return -54;
+    Timer timer(iparm[0]);
+    TraceSpan span(Trace(), "initialize");
+    StatScope stat(stats_, CKTSO_STATS_INITIALIZE);
+
+    const bool again = initialized_;
+    initialized_ = false;
+    refactorized_.clear();
+    rows_.rp.clear();
+    plans_.clear();
+    const int batch = iparm[8] < 1 ? 1 : iparm[8];
+    const idx_t n = (idx_t)ap_.size() - 1;
+    const size_t scalar = complex_ ? 2 : 1;
+    try
+    {
+        const size_t wsize = (size_t)pool_.Threads() * (size_t)n * scalar;
+        if (wsize > work_.size() || iparm[3] != 0)
+        {
+            oparm[5] = (long long)(wsize * sizeof(double));
+            std::vector<double>(wsize, 0.).swap(work_);
+            oparm[5] = 0;
+        }
+        std::vector<double> lu;
+        threshold_ = iparm[1];
+        bool incremental;
+        const int ret = Analyze(lu, again, incremental);
+        if (ret != 0) return ret;
+        stats_.Initialized(again, incremental, oparm[16] != 0);
+
+        /*factors are stored in double or, following iparm[10], in single precision, the unused array is released*/
+        TraceSpan copy(tracing_, "copy factors");
+        const size_t need = lu.size() * batch;
+        single_ = (iparm[10] != 0);
+        if (single_)
+        {
+            std::vector<double>().swap(factors_);
+            Fit(sfactors_, need);
+            std::copy(lu.begin(), lu.end(), sfactors_.begin());
+        }
+        else
+        {
+            std::vector<float>().swap(sfactors_);
+            Fit(factors_, need);
+            std::copy(lu.begin(), lu.end(), factors_.begin());
+        }
+        fsize_ = lu.size();
+        batch_ = batch;
+        refactorized_.assign(batch, 0);
+
+        oparm[5] = (long long)(n * Scalar() * sizeof(double));
+        swork_.resize((size_t)n * Scalar());
+        oparm[5] = (long long)(ax_.size() * sizeof(double));
+        values_.resize(ax_.size());
+        oparm[5] = (long long)(3 * n * Scalar() * sizeof(double));
+        rwork_.resize((size_t)(3 * n) * Scalar());
+        dirty_.resize(n);
+        oparm[5] = 0;
+        if (!stamps_.row.empty() && PlanStamps() != 0) stamps_.ptr.clear();
+    }
+    catch (const std::bad_alloc &)
+    {
+        if (0 == oparm[5]) oparm[5] = lu_.Required();
+        return -4;
+    }
+
+    const Symbolic &s = lu_.Sym();
+    oparm[7] = (long long)s.FactorNnz();
+    oparm[8] = (long long)s.Levels();
+    oparm[9] = (long long)s.nbulk;
+    oparm[18] = s.Flops();
+    Memory();
+    initialized_ = true;
+    oparm[0] = timer.Elapsed();
+    return 0;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::GpuRefactorize(const double ax[])
+{
+    if (!initialized_) return -52;
+    if (NULL == ax) return -2;
+    Timer timer(iparm[0]);
+    TraceSpan span(Trace(), "refactorize");
+    StatScope stat(stats_, CKTSO_STATS_REFACTORIZE, 1);
+    stats_.In((long long)(values_.size() * sizeof(double)));
+
+    if (Bypass(ax))
+    {
+        oparm[1] = timer.Elapsed();
+        return 0;
+    }
+    if (iparm[1] != threshold_)
+    {
+        threshold_ = iparm[1];
+        lu_.Schedule(threshold_);
+        oparm[9] = (long long)lu_.Sym().nbulk;
+    }
+    const int ret = RefactorizeOne(ax, 0, Threads(iparm[5]));
+    refactorized_[0] = (0 == ret);
+    Keep(ax);
+
+    oparm[1] = timer.Elapsed();
+    return ret;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::GpuSolve(const double b[], double x[], bool row0_column1)
+{
+    if (!initialized_) return -52;
+    if (!refactorized_[0]) return -53;
+    if (NULL == b || NULL == x) return -2;
+    Timer timer(iparm[0]);
+    TraceSpan span(Trace(), "solve");
+    StatScope stat(stats_, CKTSO_STATS_SOLVE, 2);
+    stats_.In((long long)(lu_.Sym().n * Scalar() * sizeof(double)));
+    stats_.Out((long long)(lu_.Sym().n * Scalar() * sizeof(double)));
+
+    SolveOne(0, b, x, row0_column1);
+
+    oparm[2] = timer.Elapsed();
+    return 0;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::FactorOrder(Index *fnz, Index vmap[], Index ppos[], Index qpos[]) const
+{
+    if (!initialized_) return -52;
+    const Symbolic &s = lu_.Sym();
+    if (fnz != NULL) *fnz = (Index)s.FactorNnz();
+    if (vmap != NULL) std::copy(s.amap.begin(), s.amap.end(), vmap);
+    if (ppos != NULL) std::copy(s.pinv.begin(), s.pinv.end(), ppos);
+    if (qpos != NULL) std::copy(s.qinv.begin(), s.qinv.end(), qpos);
+    return 0;
+}
+
+/*
+* the values are read in place of the factors, without the map of each nonzero. The kept values are only gathered
+* when refinement needs them, otherwise they are marked stale, which disables bypass, refinement and partial refactors
+*/
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::RefactorizeFromOrdered(const double fx[])
+{
+    const Symbolic &s = lu_.Sym();
+    oparm[12] = 0;
+    if (iparm[1] != threshold_)
+    {
+        threshold_ = iparm[1];
+        lu_.Schedule(threshold_);
+        oparm[9] = (long long)lu_.Sym().nbulk;
+    }
+    const int threads = Threads(iparm[5]);
+    const int ret = single_ ? lu_.RefactorizeOrdered(fx, SFactors(0), &work_[0], pool_, threads)
+        : lu_.RefactorizeOrdered(fx, Factors(0), &work_[0], pool_, threads);
+    refactorized_[0] = (0 == ret);
+    if (iparm[11] > 0)
+    {
+        TraceSpan keep(tracing_, "keep values");
+        const size_t scalar = Scalar();
+        for (idx_t p = 0; p < s.nnz; ++p)
+        {
+            for (size_t t = 0; t < scalar; ++t) values_[p * scalar + t] = fx[s.amap[p] * scalar + t];
+        }
+        stale_ = false;
+    }
+    else stale_ = true;
+    oparm[11] = (long long)s.n;
+    return ret;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::RefactorizeOrdered(const double fx[])
+{
+    if (!initialized_) return -52;
+    if (NULL == fx) return -2;
+    Timer timer(iparm[0]);
+    TraceSpan span(Trace(), "refactorize ordered");
+    StatScope stat(stats_, CKTSO_STATS_REFACTORIZE, 1);
+    stats_.In((long long)(lu_.Sym().FactorNnz() * Scalar() * sizeof(double)));
+
+    const int ret = RefactorizeFromOrdered(fx);
+
+    oparm[1] = timer.Elapsed();
+    return ret;
+}
+
+/*
+* rebuilds the plan of the registered stamps against the current pattern and factor order,
+* returns -2 when a stamp is outside the pattern
+*/
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::PlanStamps()
+{
+    const Symbolic &s = lu_.Sym();
+    const idx_t n = s.n;
+    const idx_t fnz = s.FactorNnz();
+    const idx_t count = (idx_t)stamps_.row.size();
+    const idx_t *row = &stamps_.row[0];
+    const idx_t *col = &stamps_.col[0];
+    stamps_.dest.clear();
+    stamps_.ptr.clear();
+    stamps_.stamp.clear();
+
+    /*stamps grouped by column, then matched to the nonzeros of their column through a row marker*/
+    std::vector<idx_t> cptr((size_t)n + 1, 0), bycol((size_t)count), where((size_t)n, -1), pos((size_t)count);
+    for (idx_t t = 0; t < count; ++t) ++cptr[col[t] + 1];
+    for (idx_t c = 0; c < n; ++c) cptr[c + 1] += cptr[c];
+    std::vector<idx_t> fill(cptr.begin(), cptr.end() - 1);
+    for (idx_t t = 0; t < count; ++t) bycol[fill[col[t]]++] = t;
+    for (idx_t c = 0; c < n; ++c)
+    {
+        if (cptr[c] == cptr[c + 1]) continue;
+        for (idx_t p = s.ap[c]; p < s.ap[c + 1]; ++p)
+        {
+            if (where[s.ai[p]] < 0) where[s.ai[p]] = s.amap[p];
+        }
+        bool ok = true;
+        for (idx_t i = cptr[c]; i < cptr[c + 1]; ++i)
+        {
+            const idx_t t = bycol[i];
+            pos[t] = where[row[t]];
+            ok &= (pos[t] >= 0);
+        }
+        for (idx_t p = s.ap[c]; p < s.ap[c + 1]; ++p) where[s.ai[p]] = -1;
+        if (!ok) return -2;
+    }
+
+    /*stamps sorted by factor position, each position is summed by one thread*/
+    std::vector<idx_t> fptr((size_t)fnz + 1, 0);
+    for (idx_t t = 0; t < count; ++t) ++fptr[pos[t] + 1];
+    idx_t ndest = 0;
+    for (idx_t d = 0; d < fnz; ++d)
+    {
+        ndest += (fptr[d + 1] != 0);
+        fptr[d + 1] += fptr[d];
+    }
+    stamps_.dest.resize((size_t)ndest);
+    stamps_.ptr.resize((size_t)ndest + 1);
+    stamps_.stamp.resize((size_t)count);
+    for (idx_t t = 0; t < count; ++t) stamps_.stamp[fptr[pos[t]]++] = t;
+    idx_t k = 0, start = 0;
+    for (idx_t d = 0; d < fnz; ++d)
+    {
+        if (fptr[d] == start) continue;
+        stamps_.dest[k] = d;
+        stamps_.ptr[k] = start;
+        start = fptr[d];
+        ++k;
+    }
+    stamps_.ptr[ndest] = count;
+    fx_.assign((size_t)fnz * Scalar(), 0.);
+    return 0;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::SetStamps(Index nstamps, const Index row[], const Index col[])
+{
+    if (!initialized_) return -52;
+    const idx_t n = lu_.Sym().n;
+    if (nstamps <= 0 || NULL == row || NULL == col) return -2;
+    for (Index t = 0; t < nstamps; ++t)
+    {
+        if (row[t] < 0 || row[t] >= n || col[t] < 0 || col[t] >= n) return -2;
+    }
+    TraceSpan span(Trace(), "plan stamps", 0, "stamps", (long long)nstamps);
+    int ret;
+    try
+    {
+        stamps_.row.assign(row, row + nstamps);
+        stamps_.col.assign(col, col + nstamps);
+        ret = PlanStamps();
+    }
+    catch (const std::bad_alloc &)
+    {
+        ret = -4;
+    }
+    if (ret != 0)
+    {
+        StampPlan().Swap(stamps_);
+        std::vector<double>().swap(fx_);
+    }
+    Memory();
+    return ret;
+}
+
+/*positions are split evenly over threads, the sums of one position are accumulated in stamp order*/
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::RefactorizeStamps(const double sv[])
+{
+    if (!initialized_) return -52;
+    if (stamps_.ptr.empty() || NULL == sv) return -2;
+    Timer timer(iparm[0]);
+    TraceSpan span(Trace(), "refactorize stamps");
+    StatScope stat(stats_, CKTSO_STATS_REFACTORIZE, 1);
+    const idx_t count = (idx_t)stamps_.stamp.size();
+    stats_.In((long long)(count * Scalar() * sizeof(double)));
+
+    {
+        const idx_t ndest = (idx_t)stamps_.dest.size();
+        TraceSpan assemble(tracing_, "assemble stamps", 0, "stamps", (long long)count);
+        const idx_t *dest = &stamps_.dest[0];
+        const idx_t *ptr = &stamps_.ptr[0];
+        const idx_t *stamp = &stamps_.stamp[0];
+        double *fx = &fx_[0];
+        const bool complex = lu_.Sym().complex;
+        auto reduce = [&](idx_t first, idx_t last)
+        {
+            for (idx_t d = first; d < last; ++d)
+            {
+                double re = 0., im = 0.;
+                if (complex)
+                {
+                    for (idx_t i = ptr[d]; i < ptr[d + 1]; ++i)
+                    {
+                        re += sv[2 * stamp[i]];
+                        im += sv[2 * stamp[i] + 1];
+                    }
+                    fx[2 * dest[d]] = re;
+                    fx[2 * dest[d] + 1] = im;
+                }
+                else
+                {
+                    for (idx_t i = ptr[d]; i < ptr[d + 1]; ++i) re += sv[stamp[i]];
+                    fx[dest[d]] = re;
+                }
+            }
+        };
+        int threads = Threads(iparm[5]);
+        if (count < STAMP_PARALLEL_MIN) threads = 1;
+        if (threads > 1)
+        {
+            pool_.Run(threads, [&](int tid)
+            {
+                reduce(ndest * tid / threads, ndest * (tid + 1) / threads);
+            });
+        }
+        else reduce(0, ndest);
+    }
+    const int ret = RefactorizeFromOrdered(&fx_[0]);
+
+    oparm[1] = timer.Elapsed();
+    return ret;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::SolveOrdered(const double b[], double x[], bool row0_column1)
+{
+    if (!initialized_) return -52;
+    if (!refactorized_[0]) return -53;
+    if (NULL == b || NULL == x) return -2;
+    Timer timer(iparm[0]);
+    TraceSpan span(Trace(), "solve ordered");
+    StatScope stat(stats_, CKTSO_STATS_SOLVE, 2);
+    const size_t size = (size_t)lu_.Sym().n * Scalar();
+    stats_.In((long long)(size * sizeof(double)));
+    stats_.Out((long long)(size * sizeof(double)));
+
+    if (x != b) memcpy(x, b, size * sizeof(double));
+    if (single_) lu_.SolveOrdered(SFactors(0), x, row0_column1);
+    else lu_.SolveOrdered(Factors(0), x, row0_column1);
+
+    oparm[2] = timer.Elapsed();
+    return 0;
+}
+
+/*the parts are interleaved into the kept values, in place of the copy of GpuRefactorize, and refactorized from there*/
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::RefactorizeSplit(const double re[], const double im[])
+{
+    if (!initialized_) return -52;
+    if (!lu_.Sym().complex || NULL == re || NULL == im) return -2;
+    Timer timer(iparm[0]);
+    TraceSpan span(Trace(), "refactorize split");
+    StatScope stat(stats_, CKTSO_STATS_REFACTORIZE, 1);
+    stats_.In((long long)(values_.size() * sizeof(double)));
+
+    if (Bypass(re, im))
+    {
+        oparm[1] = timer.Elapsed();
+        return 0;
+    }
+    if (iparm[1] != threshold_)
+    {
+        threshold_ = iparm[1];
+        lu_.Schedule(threshold_);
+        oparm[9] = (long long)lu_.Sym().nbulk;
+    }
+    {
+        TraceSpan keep(tracing_, "keep values");
+        double *v = &values_[0];
+        const size_t nnz = values_.size() / 2;
+        for (size_t p = 0; p < nnz; ++p)
+        {
+            v[2 * p] = re[p];
+            v[2 * p + 1] = im[p];
+        }
+    }
+    const int ret = RefactorizeOne(&values_[0], 0, Threads(iparm[5]));
+    refactorized_[0] = (0 == ret);
+    Keep(&values_[0]);
+
+    oparm[1] = timer.Elapsed();
+    return ret;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::SolveSplit(const double bre[], const double bim[], double xre[], double xim[], bool row0_column1)
+{
+    if (!initialized_) return -52;
+    if (!refactorized_[0]) return -53;
+    if (!lu_.Sym().complex || NULL == bre || NULL == bim || NULL == xre || NULL == xim) return -2;
+    Timer timer(iparm[0]);
+    TraceSpan span(Trace(), "solve split");
+    StatScope stat(stats_, CKTSO_STATS_SOLVE, 2);
+    stats_.In((long long)(lu_.Sym().n * 2 * sizeof(double)));
+    stats_.Out((long long)(lu_.Sym().n * 2 * sizeof(double)));
+
+    if (single_) lu_.SolveSplit(SFactors(0), bre, bim, xre, xim, &swork_[0], row0_column1);
+    else lu_.SolveSplit(Factors(0), bre, bim, xre, xim, &swork_[0], row0_column1);
+
+    oparm[2] = timer.Elapsed();
+    return 0;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::SolveMany(Index nrhs, const double b[], Index ldb, double x[], Index ldx, bool row0_column1)
+{
+    if (!initialized_) return -52;
+    if (!refactorized_[0]) return -53;
+    const idx_t n = lu_.Sym().n;
+    const idx_t scalar = (idx_t)Scalar();
+    if (nrhs < 0 || NULL == b || NULL == x || ldb < n * scalar || ldx < n * scalar || ldb % scalar != 0 || ldx % scalar != 0) return -2;
+    if (0 == nrhs) return 0;
+    Timer timer(iparm[0]);
+    TraceSpan span(Trace(), "solve many", 0, "vectors", (long long)nrhs);
+    StatScope stat(stats_, CKTSO_STATS_SOLVE_MANY);
+    stats_.In((long long)(nrhs * n * scalar * sizeof(double)));
+    stats_.Out((long long)(nrhs * n * scalar * sizeof(double)));
+
+    const int threads = Threads(iparm[7]);
+    const size_t wsize = (size_t)threads * (size_t)n * SOLVE_CHUNK * scalar;
+    if (wsize > mwork_.size())
+    {
+        try
+        {
+            mwork_.resize(wsize);
+        }
+        catch (const std::bad_alloc &)
+        {
+            oparm[5] = (long long)(wsize * sizeof(double));
+            return -4;
+        }
+        Memory();
+    }
+    if (single_) lu_.SolveMany(SFactors(0), nrhs, b, ldb / scalar, x, ldx / scalar, &mwork_[0], row0_column1, pool_, threads);
+    else lu_.SolveMany(Factors(0), nrhs, b, ldb / scalar, x, ldx / scalar, &mwork_[0], row0_column1, pool_, threads);
+
+    oparm[2] = timer.Elapsed();
+    return 0;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::RefactorizeAndSolve(const double ax[], const double b[], double x[], bool row0_column1)
+{
+    if (!initialized_) return -52;
+    if (NULL == ax || NULL == b || NULL == x) return -2;
+    Timer timer(iparm[0]);
+    TraceSpan span(Trace(), "refactorize and solve");
+    StatScope stat(stats_, CKTSO_STATS_REFACTORIZE_SOLVE);
+    stats_.In((long long)((values_.size() + lu_.Sym().n * Scalar()) * sizeof(double)));
+    stats_.Out((long long)(lu_.Sym().n * Scalar() * sizeof(double)));
+
+    if (Bypass(ax))
+    {
+        oparm[1] = timer.Elapsed();
+        SolveOne(0, b, x, row0_column1);
+        oparm[10] = timer.Elapsed();
+        oparm[2] = oparm[10] - oparm[1];
+        return 0;
+    }
+    if (iparm[1] != threshold_)
+    {
+        threshold_ = iparm[1];
+        lu_.Schedule(threshold_);
+        oparm[9] = (long long)lu_.Sym().nbulk;
+    }
+    if (single_)
+    {
+        /*the substitution sweeps run in double, so single precision factors are not fused*/
+        const int ret = RefactorizeOne(ax, 0, Threads(iparm[5]));
+        refactorized_[0] = (0 == ret);
+        Keep(ax);
+        oparm[1] = timer.Elapsed();
+        if (ret != 0) return ret;
+        SolveOne(0, b, x, row0_column1);
+        oparm[10] = timer.Elapsed();
+        oparm[2] = oparm[10] - oparm[1];
+        return 0;
+    }
+    b = Rhs(b, x);
+    const int ret = lu_.RefactorizeForward(ax, Factors(0), &work_[0], b, &swork_[0], row0_column1, pool_, Threads(iparm[5]));
+    refactorized_[0] = (0 == ret);
+    Keep(ax);
+    oparm[1] = timer.Elapsed();
+    if (ret != 0) return ret;
+
+    lu_.Backward(Factors(0), &swork_[0], x, row0_column1);
+    Refine(b, x, row0_column1);
+
+    oparm[10] = timer.Elapsed();
+    oparm[2] = oparm[10] - oparm[1];
+    return 0;
+}
+
+/*keeps the array when the new size fits, following iparm[2] and iparm[3]*/
+template <typename Base, typename Inst, typename Index>
+template <typename V>
+void HostAccelerator<Base, Inst, Index>::Fit(std::vector<V> &v, size_t need)
+{
+    if (need > v.capacity() || (iparm[3] != 0 && need < v.size()))
+    {
+        const int ratio = iparm[2] < 100 ? 100 : iparm[2];
+        std::vector<V>().swap(v);
+        const size_t length = (size_t)((double)need * ratio / 100.);
+        oparm[5] = (long long)(length * sizeof(V));
+        v.reserve(length);
+    }
+    v.resize(need);
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::RefactorizeOne(const double ax[], int k, int threads, const char dirty[])
+{
+    if (single_) return lu_.Refactorize(ax, SFactors(k), &work_[0], pool_, threads, dirty);
+    return lu_.Refactorize(ax, Factors(k), &work_[0], pool_, threads, dirty);
+}
+
+/*solves with value set k, solutions of value set 0 are refined following iparm[11] and iparm[12]*/
+template <typename Base, typename Inst, typename Index>
+void HostAccelerator<Base, Inst, Index>::SolveOne(int k, const double b[], double x[], bool row0_column1)
+{
+    if (0 == k) b = Rhs(b, x);
+    if (single_) lu_.Solve(SFactors(k), b, x, &swork_[0], row0_column1);
+    else lu_.Solve(Factors(k), b, x, &swork_[0], row0_column1);
+    if (0 == k) Refine(b, x, row0_column1);
+}
+
+/*b is kept for refinement when it is overwritten by an in-place solve*/
+template <typename Base, typename Inst, typename Index>
+const double *HostAccelerator<Base, Inst, Index>::Rhs(const double b[], const double x[])
+{
+    if (iparm[11] <= 0 || b != x) return b;
+    const size_t size = (size_t)lu_.Sym().n * Scalar();
+    memcpy(&rwork_[2 * size], b, size * sizeof(double));
+    return &rwork_[2 * size];
+}
+
+template <typename Base, typename Inst, typename Index>
+void HostAccelerator<Base, Inst, Index>::Refine(const double b[], double x[], bool row0_column1)
+{
+    oparm[14] = 0;
+    oparm[15] = 0;
+    if (iparm[11] <= 0 || stale_) return;
+    TraceSpan span(tracing_, "refine");
+    const double target = pow(10., -(double)iparm[12]);
+    double res = 0.;
+    const int steps = single_ ? lu_.Refine(&values_[0], SFactors(0), b, x, &rwork_[0], row0_column1, iparm[11], target, res)
+        : lu_.Refine(&values_[0], Factors(0), b, x, &rwork_[0], row0_column1, iparm[11], target, res);
+    const double scaled = res * 1e18;
+    oparm[14] = scaled < 9e18 ? (long long)(scaled + .5) : 9000000000000000000LL;
+    oparm[15] = steps;
+}
+
+/*
+* true when every value of ax is within the iparm[9] relative tolerance of the values of the current factors
+* with im, ax and im are the real and imaginary parts of a complex matrix
+*/
+template <typename Base, typename Inst, typename Index>
+bool HostAccelerator<Base, Inst, Index>::Bypass(const double ax[], const double im[])
+{
+    oparm[12] = 0;
+    if (iparm[9] <= 0 || !refactorized_[0] || stale_) return false;
+    TraceSpan span(tracing_, "bypass check");
+    const double tol = iparm[9] * 1e-9;
+    const double *v = &values_[0];
+    const size_t size = values_.size();
+
+    /*no early exit inside a block, so the comparison vectorizes; written as !(d <= tol) so that a NaN counts as changed*/
+    const size_t block = 1024;
+    for (size_t start = 0; start < size; start += block)
+    {
+        const size_t end = std::min(start + block, size);
+        int out = 0;
+        if (NULL == im)
+        {
+            for (size_t i = start; i < end; ++i)
+            {
+                out |= !(fabs(ax[i] - v[i]) <= tol * fabs(v[i]));
+            }
+        }
+        else
+        {
+            for (size_t i = start / 2; i < end / 2; ++i)
+            {
+                out |= !(fabs(ax[i] - v[2 * i]) <= tol * fabs(v[2 * i])) | !(fabs(im[i] - v[2 * i + 1]) <= tol * fabs(v[2 * i + 1]));
+            }
+        }
+        if (out) return false;
+    }
+
+    oparm[11] = 0;
+    oparm[12] = 1;
+    ++oparm[13];
+    stats_.Bypassed();
+    return true;
+}
+
+template <typename Base, typename Inst, typename Index>
+void HostAccelerator<Base, Inst, Index>::Keep(const double ax[])
+{
+    TraceSpan span(tracing_, "keep values");
+    if (ax != &values_[0]) memcpy(&values_[0], ax, values_.size() * sizeof(double));
+    stale_ = false;
+    oparm[11] = (long long)lu_.Sym().n;
+}
+
+/*recomputes the columns marked in dirty_ and the columns depending on them, from values_*/
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::Partial()
+{
+    if (iparm[1] != threshold_)
+    {
+        threshold_ = iparm[1];
+        lu_.Schedule(threshold_);
+        oparm[9] = (long long)lu_.Sym().nbulk;
+    }
+    idx_t count;
+    {
+        TraceSpan span(tracing_, "propagate");
+        count = lu_.Propagate(&dirty_[0]);
+    }
+    int ret = 0;
+    if (count > 0) ret = RefactorizeOne(&values_[0], 0, Threads(iparm[5]), &dirty_[0]);
+    refactorized_[0] = (0 == ret);
+    oparm[11] = (long long)count;
+    return ret;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::RefactorizeDelta(Index nchg, const Index idx[], const double val[])
+{
+    if (!initialized_) return -52;
+    if (!refactorized_[0] || stale_) return -53;
+    if (nchg < 0 || (nchg > 0 && (NULL == idx || NULL == val))) return -2;
+    const idx_t nnz = lu_.Sym().nnz;
+    for (Index i = 0; i < nchg; ++i)
+    {
+        if (idx[i] < 0 || (idx_t)idx[i] >= nnz) return -2;
+    }
+    Timer timer(iparm[0]);
+    TraceSpan span(Trace(), "refactorize delta", 0, "changes", (long long)nchg);
+    StatScope stat(stats_, CKTSO_STATS_REFACTORIZE_DELTA, 1);
+
+    const size_t scalar = Scalar();
+    stats_.In((long long)(nchg * (sizeof(Index) + scalar * sizeof(double))));
+    memset(&dirty_[0], 0, dirty_.size());
+    for (Index i = 0; i < nchg; ++i)
+    {
+        const idx_t p = (idx_t)idx[i];
+        for (size_t t = 0; t < scalar; ++t) values_[p * scalar + t] = val[i * scalar + t];
+        dirty_[lu_.ColumnOf(p)] = 1;
+    }
+    const int ret = Partial();
+
+    oparm[1] = timer.Elapsed();
+    return ret;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::RefactorizeMasked(const unsigned char changed[], const double ax[])
+{
+    if (!initialized_) return -52;
+    if (!refactorized_[0] || stale_) return -53;
+    if (NULL == changed || NULL == ax) return -2;
+    Timer timer(iparm[0]);
+    TraceSpan span(Trace(), "refactorize masked");
+    StatScope stat(stats_, CKTSO_STATS_REFACTORIZE_MASKED, 1);
+
+    const Symbolic &s = lu_.Sym();
+    const size_t scalar = Scalar();
+    memset(&dirty_[0], 0, dirty_.size());
+    idx_t count = 0;
+    for (idx_t c = 0; c < s.n; ++c)
+    {
+        bool any = false;
+        for (idx_t p = s.ap[c]; p < s.ap[c + 1]; ++p)
+        {
+            if (changed[p >> 3] & (1 << (p & 7)))
+            {
+                for (size_t t = 0; t < scalar; ++t) values_[p * scalar + t] = ax[p * scalar + t];
+                any = true;
+                ++count;
+            }
+        }
+        if (any) dirty_[s.qinv[c]] = 1;
+    }
+    stats_.In((long long)((s.nnz + 7) / 8 + count * scalar * sizeof(double)));
+    const int ret = Partial();
+
+    oparm[1] = timer.Elapsed();
+    return ret;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::RefactorizeBatch(const double *ax[], int k)
+{
+    if (!initialized_) return -52;
+    if (NULL == ax || k <= 0 || k > batch_) return -2;
+    for (int i = 0; i < k; ++i)
+    {
+        if (NULL == ax[i]) return -2;
+    }
+    Timer timer(iparm[0]);
+    TraceSpan span(Trace(), "refactorize batch", 0, "sets", k);
+    StatScope stat(stats_, CKTSO_STATS_REFACTORIZE_BATCH);
+    stats_.In((long long)(k * values_.size() * sizeof(double)));
+
+    if (iparm[1] != threshold_)
+    {
+        threshold_ = iparm[1];
+        lu_.Schedule(threshold_);
+        oparm[9] = (long long)lu_.Sym().nbulk;
+    }
+
+    /*value sets are spread over threads when there are enough of them, otherwise each one is refactorized in parallel*/
+    const int threads = Threads(iparm[5]);
+    int ret = 0;
+    if (k >= threads)
+    {
+        const size_t wsize = (size_t)lu_.Sym().n * Scalar();
+        std::atomic<int> next(0);
+        std::atomic<int> bad(0);
+        pool_.Run(threads, [&](int tid)
+        {
+            double *w = &work_[0] + tid * wsize;
+            for (;;)
+            {
+                const int i = next.fetch_add(1, std::memory_order_relaxed);
+                if (i >= k) break;
+                TraceSpan set(tracing_, "value set", tid, "set", i);
+                const int r = single_ ? lu_.RefactorizeSequential(ax[i], SFactors(i), w) : lu_.RefactorizeSequential(ax[i], Factors(i), w);
+                refactorized_[i] = (0 == r);
+                if (r != 0) bad.store(r, std::memory_order_relaxed);
+            }
+        });
+        ret = bad.load();
+    }
+    else
+    {
+        for (int i = 0; i < k; ++i)
+        {
+            TraceSpan set(tracing_, "value set", 0, "set", i);
+            const int r = RefactorizeOne(ax[i], i, threads);
+            refactorized_[i] = (0 == r);
+            if (r != 0) ret = r;
+        }
+    }
+    Keep(ax[0]);
+
+    oparm[1] = timer.Elapsed();
+    return ret;
+}
+
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::SolveBatch(int k, const double b[], double x[], bool row0_column1)
+{
+    if (!initialized_) return -52;
+    if (k < 0 || k >= batch_ || NULL == b || NULL == x) return -2;
+    if (!refactorized_[k]) return -53;
+    Timer timer(iparm[0]);
+    TraceSpan span(Trace(), "solve batch", 0, "set", k);
+    StatScope stat(stats_, CKTSO_STATS_SOLVE_BATCH, 2);
+    stats_.In((long long)(lu_.Sym().n * Scalar() * sizeof(double)));
+    stats_.Out((long long)(lu_.Sym().n * Scalar() * sizeof(double)));
+
+    SolveOne(k, b, x, row0_column1);
+
+    oparm[2] = timer.Elapsed();
+    return 0;
+}
+
+/*plans are looked up by pattern, the oldest one is replaced on a miss*/
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::SolveSparse(Index nnz, const Index idx[], const double val[], Index nout, const Index out[], double x[], bool row0_column1)
+{
+    if (!initialized_) return -52;
+    if (!refactorized_[0]) return -53;
+    const idx_t n = lu_.Sym().n;
+    if (nnz < 0 || (nnz > 0 && (NULL == idx || NULL == val)) || (out != NULL && nout < 0) || NULL == x) return -2;
+    for (Index i = 0; i < nnz; ++i)
+    {
+        if (idx[i] < 0 || idx[i] >= n) return -2;
+    }
+    for (Index r = 0; out != NULL && r < nout; ++r)
+    {
+        if (out[r] < 0 || out[r] >= n) return -2;
+    }
+    if (out != NULL && 0 == nout) return 0;
+    Timer timer(iparm[0]);
+    TraceSpan span(Trace(), "solve sparse", 0, "nonzeros", (long long)nnz);
+    StatScope stat(stats_, CKTSO_STATS_SOLVE_SPARSE);
+    stats_.In((long long)(nnz * (sizeof(Index) + Scalar() * sizeof(double)) + (NULL == out ? 0 : nout * sizeof(Index))));
+    stats_.Out((long long)((NULL == out ? n : nout) * Scalar() * sizeof(double)));
+
+    unsigned long long h = HashMix(0xcbf29ce484222325ULL, row0_column1 ? 1 : 0);
+    h = HashArray(h, idx, (size_t)nnz);
+    h = NULL == out ? HashMix(h, ~0ULL) : HashArray(h, out, (size_t)nout);
+    SparsePlan *plan = NULL;
+    for (size_t i = 0; i < plans_.size() && NULL == plan; ++i)
+    {
+        const SparsePlan &p = plans_[i];
+        if (p.hash != h || p.row0_column1 != row0_column1 || p.b.size() != (size_t)nnz || p.out.size() != (size_t)(NULL == out ? 0 : nout)) continue;
+        if (std::equal(p.b.begin(), p.b.end(), idx) && (NULL == out || std::equal(p.out.begin(), p.out.end(), out))) plan = &plans_[i];
+    }
+    oparm[27] = plan != NULL;
+    if (NULL == plan)
+    {
+        TraceSpan reach(tracing_, "plan sparse solve");
+        try
+        {
+            if (rows_.rp.empty())
+            {
+                lu_.Rows(rows_);
+                oparm[5] = (long long)(n * Scalar() * sizeof(double));
+                ywork_.assign((size_t)n * Scalar(), 0.);
+                oparm[5] = (long long)n;
+                mark_.assign((size_t)n, 0);
+                oparm[5] = 0;
+                Memory();
+            }
+            if (plans_.size() < HOST_SPARSE_PLANS)
+            {
+                plans_.push_back(SparsePlan());
+                plan = &plans_.back();
+            }
+            else
+            {
+                plan = &plans_[nextplan_];
+                nextplan_ = (nextplan_ + 1) % HOST_SPARSE_PLANS;
+            }
+            plan->hash = 0;
+            plan->row0_column1 = row0_column1;
+            plan->b.assign(idx, idx + nnz);
+            if (NULL == out) plan->out.clear();
+            else plan->out.assign(out, out + nout);
+            lu_.PlanSparse(rows_, *plan, mark_);
+            plan->hash = h;
+        }
+        catch (const std::bad_alloc &)
+        {
+            rows_.rp.clear();
+            plans_.clear();
+            if (0 == oparm[5]) oparm[5] = lu_.Required();
+            return -4;
+        }
+    }
+    oparm[26] = (long long)(plan->forward.size() + plan->backward.size());
+
+    if (single_) lu_.SolveSparse(SFactors(0), *plan, val, x, &ywork_[0]);
+    else lu_.SolveSparse(Factors(0), *plan, val, x, &ywork_[0]);
+
+    oparm[2] = timer.Elapsed();
+    return 0;
+}
+
+/*complex values of one frequency point, g + j*omega*c*/
+static void FormPoint(double ax[], const double g[], const double c[], double omega, size_t nnz)
+{
+    for (size_t p = 0; p < nnz; ++p)
+    {
+        ax[2 * p] = g[p];
+        ax[2 * p + 1] = omega * c[p];
+    }
+}
+
+/*
+* points are spread over min(#threads, batch count) workers, each forming, refactorizing and solving its own points
+* in its own value set, so that forming a point overlaps the refactors of the others. With one worker, each point is
+* refactorized in parallel mode
+*/
+template <typename Base, typename Inst, typename Index>
+int HostAccelerator<Base, Inst, Index>::FrequencySweep(const double g[], const double c[], Index npoints, const double omega[],
+    const double b[], Index ldb, double x[], Index ldx, bool row0_column1)
+{
+    if (!initialized_) return -52;
+    const Symbolic &s = lu_.Sym();
+    const idx_t n = s.n;
+    if (!s.complex || npoints < 0 || NULL == g || NULL == c || NULL == omega || NULL == b || NULL == x) return -2;
+    if ((ldb != 0 && ldb < 2 * n) || ldx < 2 * n || ldb % 2 != 0 || ldx % 2 != 0) return -2;
+    oparm[28] = -1;
+    if (0 == npoints) return 0;
+    Timer timer(iparm[0]);
+    TraceSpan span(Trace(), "frequency sweep", 0, "points", (long long)npoints);
+    StatScope stat(stats_, CKTSO_STATS_FREQUENCY_SWEEP);
+    const size_t nnz = (size_t)s.nnz;
+    stats_.In((long long)((2 * nnz + npoints + (0 == ldb ? 1 : npoints) * 2 * n) * sizeof(double)));
+    stats_.Out((long long)(npoints * 2 * n * sizeof(double)));
+
+    if (iparm[1] != threshold_)
+    {
+        threshold_ = iparm[1];
+        lu_.Schedule(threshold_);
+        oparm[9] = (long long)lu_.Sym().nbulk;
+    }
+    const int threads = Threads(iparm[5]);
+    int workers = threads < batch_ ? threads : batch_;
+    if ((Index)workers > npoints) workers = (int)npoints;
+    const size_t stride = 2 * nnz + 2 * (size_t)n; /*values, then solve work space*/
+    if (workers * stride > sweep_.size())
+    {
+        try
+        {
+            sweep_.resize(workers * stride);
+        }
+        catch (const std::bad_alloc &)
+        {
+            oparm[5] = (long long)(workers * stride * sizeof(double));
+            return -4;
+        }
+        Memory();
+    }
+
+    /*points failing to refactorize leave their solutions unset, the first one is reported*/
+    std::mutex lock;
+    int ret = 0;
+    auto point = [&](Index i, int k, int tid, int parallel)
+    {
+        TraceSpan one(tracing_, "frequency point", tid, "point", (long long)i);
+        double *ax = &sweep_[k * stride];
+        FormPoint(ax, g, c, omega[i], nnz);
+        int r;
+        if (parallel > 1) r = RefactorizeOne(ax, k, parallel);
+        else if (single_) r = lu_.RefactorizeSequential(ax, SFactors(k), &work_[0] + (size_t)tid * 2 * n);
+        else r = lu_.RefactorizeSequential(ax, Factors(k), &work_[0] + (size_t)tid * 2 * n);
+        if (r != 0)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (oparm[28] < 0 || i < oparm[28])
+            {
+                oparm[28] = (long long)i;
+                ret = r;
+            }
+            return;
+        }
+        const double *bi = b + (size_t)(0 == ldb ? 0 : i) * ldb;
+        double *xi = x + (size_t)i * ldx;
+        if (single_) lu_.Solve(SFactors(k), bi, xi, ax + 2 * nnz, row0_column1);
+        else lu_.Solve(Factors(k), bi, xi, ax + 2 * nnz, row0_column1);
+    };
+    if (workers > 1)
+    {
+        std::atomic<long long> next(0);
+        pool_.Run(workers, [&](int tid)
+        {
+            for (;;)
+            {
+                const long long i = next.fetch_add(1, std::memory_order_relaxed);
+                if (i >= (long long)npoints) break;
+                point((Index)i, tid, tid, 1);
+            }
+        });
+    }
+    else
+    {
+        for (Index i = 0; i < npoints; ++i) point(i, 0, 0, threads);
+    }
+    /*the value sets used hold the factors of arbitrary points*/
+    for (int k = 0; k < workers; ++k) refactorized_[k] = 0;
+
+    oparm[1] = timer.Elapsed();
+    return ret;
+}
+
+template class HostAccelerator<__CKTSO_GPU, ICktSo, int>;
+template class HostAccelerator<__CKTSO_L_GPU, ICktSo_L, long long>;
+
+template <typename Accel>
+static int Create(Accel **accel, int **iparm, const long long **oparm, int threads)
+{
+    if (NULL == accel || NULL == iparm || NULL == oparm) return -2;
+    Accel *a = NULL;
+    try
+    {
+        a = new Accel(threads);
+    }
+    catch (const std::exception &)
+    {
+        *accel = NULL;
+        return -4;
+    }
+    *accel = a;
+    *iparm = a->iparm;
+    *oparm = a->oparm;
+    return 0;
+}
+
+/*for a GPU-accelerator, vectors are solved one by one*/
+template <typename Accel, typename HostType, typename Index>
+static int SolveMany(Accel *accel, Index nrhs, const double b[], Index ldb, double x[], Index ldx, bool row0_column1)
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    if (a != NULL) return a->SolveMany(nrhs, b, ldb, x, ldx, row0_column1);
+    if (nrhs < 0 || NULL == b || NULL == x || ldb <= 0 || ldx <= 0) return -2;
+    for (Index r = 0; r < nrhs; ++r)
+    {
+        const int ret = accel->GpuSolve(b + (size_t)r * ldb, x + (size_t)r * ldx, row0_column1);
+        if (ret != 0) return ret;
+    }
+    return 0;
+}
+
+/*for a GPU-accelerator, the two routines are called one after another*/
+template <typename Accel, typename HostType>
+static int RefactorizeAndSolve(Accel *accel, const double ax[], const double b[], double x[], bool row0_column1)
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    if (a != NULL) return a->RefactorizeAndSolve(ax, b, x, row0_column1);
+    const int ret = accel->GpuRefactorize(ax);
+    return 0 == ret ? accel->GpuSolve(b, x, row0_column1) : ret;
+}
+
+/*a GPU-accelerator does not keep the matrix values, so it can only refactorize the full matrix given by a change bitmap*/
+template <typename Accel, typename HostType, typename Index>
+static int RefactorizeDelta(Accel *accel, Index nchg, const Index idx[], const double val[])
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    return NULL == a ? -55 : a->RefactorizeDelta(nchg, idx, val);
+}
+
+template <typename Accel, typename HostType>
+static int RefactorizeMasked(Accel *accel, const unsigned char changed[], const double ax[])
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    return NULL == a ? accel->GpuRefactorize(ax) : a->RefactorizeMasked(changed, ax);
+}
+
+/*a GPU-accelerator keeps one set of factors, so only a batch of one is accepted*/
+template <typename Accel, typename HostType>
+static int RefactorizeBatch(Accel *accel, const double *ax[], int k)
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    if (a != NULL) return a->RefactorizeBatch(ax, k);
+    if (NULL == ax || k <= 0) return -2;
+    return 1 == k ? accel->GpuRefactorize(ax[0]) : -55;
+}
+
+/*the dimension of a GPU-accelerator is not known here, so b cannot be expanded for it*/
+template <typename Accel, typename HostType, typename Index>
+static int SolveSparse(Accel *accel, Index nnz, const Index idx[], const double val[], Index nout, const Index out[], double x[], bool row0_column1)
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    return NULL == a ? -55 : a->SolveSparse(nnz, idx, val, nout, out, x, row0_column1);
+}
+
+template <typename Accel, typename HostType, typename Index>
+static int GetFactorOrder(Accel *accel, Index *fnz, Index vmap[], Index ppos[], Index qpos[])
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    return NULL == a ? -55 : a->FactorOrder(fnz, vmap, ppos, qpos);
+}
+
+template <typename Accel, typename HostType, typename Index>
+static int SetStamps(Accel *accel, Index nstamps, const Index row[], const Index col[])
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    return NULL == a ? -55 : a->SetStamps(nstamps, row, col);
+}
+
+template <typename Accel, typename HostType>
+static int RefactorizeStamps(Accel *accel, const double sv[])
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    return NULL == a ? -55 : a->RefactorizeStamps(sv);
+}
+
+template <typename Accel, typename HostType>
+static int RefactorizeOrdered(Accel *accel, const double fx[])
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    return NULL == a ? -55 : a->RefactorizeOrdered(fx);
+}
+
+template <typename Accel, typename HostType>
+static int SolveOrdered(Accel *accel, const double b[], double x[], bool row0_column1)
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    return NULL == a ? -55 : a->SolveOrdered(b, x, row0_column1);
+}
+
+template <typename Accel, typename HostType>
+static int RefactorizeSplit(Accel *accel, const double re[], const double im[])
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    return NULL == a ? -55 : a->RefactorizeSplit(re, im);
+}
+
+template <typename Accel, typename HostType>
+static int SolveSplit(Accel *accel, const double bre[], const double bim[], double xre[], double xim[], bool row0_column1)
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    return NULL == a ? -55 : a->SolveSplit(bre, bim, xre, xim, row0_column1);
+}
+
+template <typename Accel, typename HostType, typename Index>
+static int FrequencySweep(Accel *accel, const double g[], const double c[], Index npoints, const double omega[],
+    const double b[], Index ldb, double x[], Index ldx, bool row0_column1)
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    return NULL == a ? -55 : a->FrequencySweep(g, c, npoints, omega, b, ldb, x, ldx, row0_column1);
+}
+
+template <typename Accel, typename HostType>
+static int SolveBatch(Accel *accel, int k, const double b[], double x[], bool row0_column1)
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    if (a != NULL) return a->SolveBatch(k, b, x, row0_column1);
+    return 0 == k ? accel->GpuSolve(b, x, row0_column1) : -55;
+}
+
+static bool HostWanted(int gpuid)
+{
+    if (gpuid < 0) return true;
+    const char *env = getenv("CKTSO_GPU_HOST");
+    return env != NULL && atoi(env) != 0;
+}
+
+}
+
+using namespace cktso_host;
+
+int CKTSO_CreateHostAccelerator(ICktSoGpu *accel, int **iparm, const long long **oparm, int threads)
+{
+    HostAccel *a = NULL;
+    const int ret = Create(&a, iparm, oparm, threads);
+    if (accel != NULL) *accel = a;
+    return ret;
+}
+
+int CKTSO_L_CreateHostAccelerator(ICktSoGpu_L *accel, int **iparm, const long long **oparm, int threads)
+{
+    HostAccel_L *a = NULL;
+    const int ret = Create(&a, iparm, oparm, threads);
+    if (accel != NULL) *accel = a;
+    return ret;
+}
+
+int CKTSO_CreateAccelerator(ICktSoGpu *accel, int **iparm, const long long **oparm, int gpuid)
+{
+    if (!HostWanted(gpuid))
+    {
+        const int ret = CKTSO_CreateGpuAccelerator(accel, iparm, oparm, gpuid);
+        if (ret != 100) return ret;
+    }
+    return CKTSO_CreateHostAccelerator(accel, iparm, oparm, 0);
+}
+
+int CKTSO_L_CreateAccelerator(ICktSoGpu_L *accel, int **iparm, const long long **oparm, int gpuid)
+{
+    if (!HostWanted(gpuid))
+    {
+        const int ret = CKTSO_L_CreateGpuAccelerator(accel, iparm, oparm, gpuid);
+        if (ret != 100) return ret;
+    }
+    return CKTSO_L_CreateHostAccelerator(accel, iparm, oparm, 0);
+}
+
+int CKTSO_SetHostMatrix(ICktSoGpu accel, bool is_complex, int n, const int ap[], const int ai[], const double ax[])
+{
+    if (NULL == accel) return -1;
+    Dispatch *d = dynamic_cast<Dispatch *>(accel);
+    if (d != NULL) return CKTSO_SetHostMatrix(d->Device(), is_complex, n, ap, ai, ax);
+    HostAccel *a = dynamic_cast<HostAccel *>(accel);
+    return NULL == a ? 0 : a->SetMatrix(is_complex, n, ap, ai, ax);
+}
+
+int CKTSO_L_SetHostMatrix(ICktSoGpu_L accel, bool is_complex, long long n, const long long ap[], const long long ai[], const double ax[])
+{
+    if (NULL == accel) return -1;
+    Dispatch_L *d = dynamic_cast<Dispatch_L *>(accel);
+    if (d != NULL) return CKTSO_L_SetHostMatrix(d->Device(), is_complex, n, ap, ai, ax);
+    HostAccel_L *a = dynamic_cast<HostAccel_L *>(accel);
+    return NULL == a ? 0 : a->SetMatrix(is_complex, n, ap, ai, ax);
+}
+
+bool CKTSO_IsHostAccelerator(ICktSoGpu accel)
+{
+    return dynamic_cast<HostAccel *>(accel) != NULL;
+}
+
+bool CKTSO_L_IsHostAccelerator(ICktSoGpu_L accel)
+{
+    return dynamic_cast<HostAccel_L *>(accel) != NULL;
+}
+
+int CKTSO_SetHostCache(ICktSoGpu accel, const char dir[])
+{
+    if (NULL == accel) return -1;
+    Dispatch *d = dynamic_cast<Dispatch *>(accel);
+    if (d != NULL) return CKTSO_SetHostCache(d->Device(), dir);
+    HostAccel *a = dynamic_cast<HostAccel *>(accel);
+    return NULL == a ? 0 : a->SetCache(dir);
+}
+
+int CKTSO_L_SetHostCache(ICktSoGpu_L accel, const char dir[])
+{
+    if (NULL == accel) return -1;
+    Dispatch_L *d = dynamic_cast<Dispatch_L *>(accel);
+    if (d != NULL) return CKTSO_L_SetHostCache(d->Device(), dir);
+    HostAccel_L *a = dynamic_cast<HostAccel_L *>(accel);
+    return NULL == a ? 0 : a->SetCache(dir);
+}
+
+int CKTSO_GpuSolveMany(ICktSoGpu accel, int nrhs, const double b[], int ldb, double x[], int ldx, bool row0_column1)
+{
+    return SolveMany<__CKTSO_GPU, HostAccel, int>(accel, nrhs, b, ldb, x, ldx, row0_column1);
+}
+
+int CKTSO_L_GpuSolveMany(ICktSoGpu_L accel, long long nrhs, const double b[], long long ldb, double x[], long long ldx, bool row0_column1)
+{
+    return SolveMany<__CKTSO_L_GPU, HostAccel_L, long long>(accel, nrhs, b, ldb, x, ldx, row0_column1);
+}
+
+int CKTSO_GpuRefactorizeBatch(ICktSoGpu accel, const double *ax[], int k)
+{
+    return RefactorizeBatch<__CKTSO_GPU, HostAccel>(accel, ax, k);
+}
+
+int CKTSO_L_GpuRefactorizeBatch(ICktSoGpu_L accel, const double *ax[], int k)
+{
+    return RefactorizeBatch<__CKTSO_L_GPU, HostAccel_L>(accel, ax, k);
+}
+
+int CKTSO_GpuSolveBatch(ICktSoGpu accel, int k, const double b[], double x[], bool row0_column1)
+{
+    return SolveBatch<__CKTSO_GPU, HostAccel>(accel, k, b, x, row0_column1);
+}
+
+int CKTSO_L_GpuSolveBatch(ICktSoGpu_L accel, int k, const double b[], double x[], bool row0_column1)
+{
+    return SolveBatch<__CKTSO_L_GPU, HostAccel_L>(accel, k, b, x, row0_column1);
+}
+
+int CKTSO_GpuSolveSparse(ICktSoGpu accel, int nnz, const int idx[], const double val[], int nout, const int out[], double x[], bool row0_column1)
+{
+    return SolveSparse<__CKTSO_GPU, HostAccel, int>(accel, nnz, idx, val, nout, out, x, row0_column1);
+}
+
+int CKTSO_L_GpuSolveSparse(ICktSoGpu_L accel, long long nnz, const long long idx[], const double val[], long long nout, const long long out[], double x[], bool row0_column1)
+{
+    return SolveSparse<__CKTSO_L_GPU, HostAccel_L, long long>(accel, nnz, idx, val, nout, out, x, row0_column1);
+}
+
+int CKTSO_GpuGetFactorOrder(ICktSoGpu accel, int *fnz, int vmap[], int ppos[], int qpos[])
+{
+    return GetFactorOrder<__CKTSO_GPU, HostAccel, int>(accel, fnz, vmap, ppos, qpos);
+}
+
+int CKTSO_L_GpuGetFactorOrder(ICktSoGpu_L accel, long long *fnz, long long vmap[], long long ppos[], long long qpos[])
+{
+    return GetFactorOrder<__CKTSO_L_GPU, HostAccel_L, long long>(accel, fnz, vmap, ppos, qpos);
+}
+
+int CKTSO_GpuRefactorizeOrdered(ICktSoGpu accel, const double fx[])
+{
+    return RefactorizeOrdered<__CKTSO_GPU, HostAccel>(accel, fx);
+}
+
+int CKTSO_L_GpuRefactorizeOrdered(ICktSoGpu_L accel, const double fx[])
+{
+    return RefactorizeOrdered<__CKTSO_L_GPU, HostAccel_L>(accel, fx);
+}
+
+int CKTSO_GpuSolveOrdered(ICktSoGpu accel, const double b[], double x[], bool row0_column1)
+{
+    return SolveOrdered<__CKTSO_GPU, HostAccel>(accel, b, x, row0_column1);
+}
+
+int CKTSO_L_GpuSolveOrdered(ICktSoGpu_L accel, const double b[], double x[], bool row0_column1)
+{
+    return SolveOrdered<__CKTSO_L_GPU, HostAccel_L>(accel, b, x, row0_column1);
+}
+
+int CKTSO_GpuSetStamps(ICktSoGpu accel, int nstamps, const int row[], const int col[])
+{
+    return SetStamps<__CKTSO_GPU, HostAccel, int>(accel, nstamps, row, col);
+}
+
+int CKTSO_L_GpuSetStamps(ICktSoGpu_L accel, long long nstamps, const long long row[], const long long col[])
+{
+    return SetStamps<__CKTSO_L_GPU, HostAccel_L, long long>(accel, nstamps, row, col);
+}
+
+int CKTSO_GpuRefactorizeStamps(ICktSoGpu accel, const double sv[])
+{
+    return RefactorizeStamps<__CKTSO_GPU, HostAccel>(accel, sv);
+}
+
+int CKTSO_L_GpuRefactorizeStamps(ICktSoGpu_L accel, const double sv[])
+{
+    return RefactorizeStamps<__CKTSO_L_GPU, HostAccel_L>(accel, sv);
+}
+
+int CKTSO_GpuRefactorizeSplit(ICktSoGpu accel, const double re[], const double im[])
+{
+    return RefactorizeSplit<__CKTSO_GPU, HostAccel>(accel, re, im);
+}
+
+int CKTSO_L_GpuRefactorizeSplit(ICktSoGpu_L accel, const double re[], const double im[])
+{
+    return RefactorizeSplit<__CKTSO_L_GPU, HostAccel_L>(accel, re, im);
+}
+
+int CKTSO_GpuSolveSplit(ICktSoGpu accel, const double bre[], const double bim[], double xre[], double xim[], bool row0_column1)
+{
+    return SolveSplit<__CKTSO_GPU, HostAccel>(accel, bre, bim, xre, xim, row0_column1);
+}
+
+int CKTSO_L_GpuSolveSplit(ICktSoGpu_L accel, const double bre[], const double bim[], double xre[], double xim[], bool row0_column1)
+{
+    return SolveSplit<__CKTSO_L_GPU, HostAccel_L>(accel, bre, bim, xre, xim, row0_column1);
+}
+
+int CKTSO_GpuFrequencySweep(ICktSoGpu accel, const double g[], const double c[], int npoints, const double omega[],
+    const double b[], int ldb, double x[], int ldx, bool row0_column1)
+{
+    return FrequencySweep<__CKTSO_GPU, HostAccel, int>(accel, g, c, npoints, omega, b, ldb, x, ldx, row0_column1);
+}
+
+int CKTSO_L_GpuFrequencySweep(ICktSoGpu_L accel, const double g[], const double c[], long long npoints, const double omega[],
+    const double b[], long long ldb, double x[], long long ldx, bool row0_column1)
+{
+    return FrequencySweep<__CKTSO_L_GPU, HostAccel_L, long long>(accel, g, c, npoints, omega, b, ldb, x, ldx, row0_column1);
+}
+
+int CKTSO_GpuRefactorizeAndSolve(ICktSoGpu accel, const double ax[], const double b[], double x[], bool row0_column1)
+{
+    return RefactorizeAndSolve<__CKTSO_GPU, HostAccel>(accel, ax, b, x, row0_column1);
+}
+
+int CKTSO_L_GpuRefactorizeAndSolve(ICktSoGpu_L accel, const double ax[], const double b[], double x[], bool row0_column1)
+{
+    return RefactorizeAndSolve<__CKTSO_L_GPU, HostAccel_L>(accel, ax, b, x, row0_column1);
+}
+
+int CKTSO_GpuRefactorizeDelta(ICktSoGpu accel, int nchg, const int idx[], const double val[])
+{
+    return RefactorizeDelta<__CKTSO_GPU, HostAccel, int>(accel, nchg, idx, val);
+}
+
+int CKTSO_L_GpuRefactorizeDelta(ICktSoGpu_L accel, long long nchg, const long long idx[], const double val[])
+{
+    return RefactorizeDelta<__CKTSO_L_GPU, HostAccel_L, long long>(accel, nchg, idx, val);
+}
+
+int CKTSO_GpuRefactorizeMasked(ICktSoGpu accel, const unsigned char changed[], const double ax[])
+{
+    return RefactorizeMasked<__CKTSO_GPU, HostAccel>(accel, changed, ax);
+}
+
+int CKTSO_L_GpuRefactorizeMasked(ICktSoGpu_L accel, const unsigned char changed[], const double ax[])
+{
+    return RefactorizeMasked<__CKTSO_L_GPU, HostAccel_L>(accel, changed, ax);
+}
@@ -0,0 +1,183 @@
+/*host accelerator instances behind ICktSoGpu and ICktSoGpu_L*/
+#ifndef __CKTSO_HOST_ACCEL__
+#define __CKTSO_HOST_ACCEL__
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../cktso-gpu-host.h"
+#include "host_lu.h"
+#include "host_pool.h"
+#include "host_stats.h"
+#include "host_trace.h"
+
+namespace cktso_host
+{
+
+#define HOST_IPARM_SIZE 32
+#define HOST_OPARM_SIZE 32
+#define HOST_PIVOT_TOL  1e-3
+#define HOST_SPARSE_PLANS 16
+#define STAMP_PARALLEL_MIN 16384 /*stamps are summed in one thread below this count*/
+
+/*
+* StampPlan: stamps sorted by the factor position they are summed into, so that each position is written by one thread
+*/
+struct StampPlan
+{
+    std::vector<idx_t> row, col; /*as registered, the plan is rebuilt from them by each initialization*/
+    std::vector<idx_t> dest; /*factor positions receiving stamps, ascending*/
+    std::vector<idx_t> ptr; /*stamps of dest[d] are stamp[ptr[d] ... ptr[d+1]-1], empty when there is no valid plan*/
+    std::vector<idx_t> stamp;
+
+    size_t Capacity() const
+    {
+        return row.capacity() + col.capacity() + dest.capacity() + ptr.capacity() + stamp.capacity();
+    }
+    void Swap(StampPlan &other)
+    {
+        row.swap(other.row);
+        col.swap(other.col);
+        dest.swap(other.dest);
+        ptr.swap(other.ptr);
+        stamp.swap(other.stamp);
+    }
+};
+
+/*
+* Timer: follows iparm[0], >0 microsecond-level, <0 millisecond-level (reported in microseconds), 0 disabled
+*/
+class Timer
+{
+public:
+    explicit Timer(int mode) : mode_(mode)
+    {
+        if (mode_ != 0) start_ = std::chrono::steady_clock::now();
+    }
+
+    long long Elapsed() const
+    {
+        if (0 == mode_) return 0;
+        const std::chrono::steady_clock::duration d = std::chrono::steady_clock::now() - start_;
+        if (mode_ > 0) return (long long)std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        return (long long)std::chrono::duration_cast<std::chrono::milliseconds>(d).count() * 1000;
+    }
+
+private:
+    const int mode_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+template <typename Base, typename Inst, typename Index>
+class HostAccelerator : public Base
+{
+public:
+    explicit HostAccelerator(int threads);
+    virtual ~HostAccelerator() {}
+
+    virtual int _CDECL_ DestroyGpuAccelerator();
+    virtual int _CDECL_ InitializeGpuAccelerator(_IN_ Inst inst);
+    virtual int _CDECL_ GpuRefactorize(_IN_ const double ax[]);
+    virtual int _CDECL_ GpuSolve(_IN_ const double b[], _OUT_ double x[], _IN_ bool row0_column1);
+
+    int SetMatrix(bool is_complex, Index n, const Index ap[], const Index ai[], const double ax[]);
+    int SetCache(const char dir[]);
+    int FactorOrder(Index *fnz, Index vmap[], Index ppos[], Index qpos[]) const;
+    int RefactorizeOrdered(const double fx[]);
+    int SetStamps(Index nstamps, const Index row[], const Index col[]);
+    int RefactorizeStamps(const double sv[]);
+    int SolveOrdered(const double b[], double x[], bool row0_column1);
+    int RefactorizeSplit(const double re[], const double im[]);
+    int SolveSplit(const double bre[], const double bim[], double xre[], double xim[], bool row0_column1);
+    int SolveMany(Index nrhs, const double b[], Index ldb, double x[], Index ldx, bool row0_column1);
+    int RefactorizeBatch(const double *ax[], int k);
+    int RefactorizeAndSolve(const double ax[], const double b[], double x[], bool row0_column1);
+    int RefactorizeDelta(Index nchg, const Index idx[], const double val[]);
+    int RefactorizeMasked(const unsigned char changed[], const double ax[]);
+    int SolveBatch(int k, const double b[], double x[], bool row0_column1);
+    int SolveSparse(Index nnz, const Index idx[], const double val[], Index nout, const Index out[], double x[], bool row0_column1);
+    int FrequencySweep(const double g[], const double c[], Index npoints, const double omega[], const double b[], Index ldb, double x[], Index ldx, bool row0_column1);
+    int Threads(int parm) const;
+    int DumpTrace(const char file[], bool binary, bool clear);
+    void GetStats(CKTSO_GPU_STATS *stats, bool reset)
+    {
+        stats_.Get(stats, reset);
+    }
+    /*symbolic structure, NULL when not initialized*/
+    const Symbolic *Structure() const
+    {
+        return initialized_ ? &lu_.Sym() : NULL;
+    }
+
+    int iparm[HOST_IPARM_SIZE];
+    long long oparm[HOST_OPARM_SIZE];
+
+protected:
+    size_t Scalar() const
+    {
+        return lu_.Sym().complex ? 2 : 1;
+    }
+    void Memory();
+    int Analyze(std::vector<double> &lu, bool again, bool &incremental);
+    template <typename V> void Fit(std::vector<V> &v, size_t need);
+    int RefactorizeOne(const double ax[], int k, int threads, const char dirty[] = NULL);
+    void SolveOne(int k, const double b[], double x[], bool row0_column1);
+    const double *Rhs(const double b[], const double x[]);
+    void Refine(const double b[], double x[], bool row0_column1);
+    bool Bypass(const double ax[], const double im[] = NULL);
+    void Keep(const double ax[]);
+    int Partial();
+    int RefactorizeFromOrdered(const double fx[]);
+    int PlanStamps();
+    Tracer *Trace();
+    double *Factors(int k)
+    {
+        return &factors_[(size_t)k * fsize_];
+    }
+    float *SFactors(int k)
+    {
+        return &sfactors_[(size_t)k * fsize_];
+    }
+
+    ThreadPool pool_;
+    HostLU lu_;
+    bool complex_;
+    std::vector<idx_t> ap_, ai_;
+    std::vector<double> ax_;
+    std::vector<double> factors_; /*batch_ value sets of fsize_ doubles, sharing the symbolic structure*/
+    std::vector<float> sfactors_; /*same as factors_, in single precision*/
+    size_t fsize_;
+    int batch_;
+    bool single_;
+    bool stale_; /*values_ are not those of factor 0, which was refactorized from factor-ordered values*/
+    std::vector<double> work_; /*refactor work space, kept zero*/
+    std::vector<double> swork_;
+    std::vector<double> mwork_;
+    std::vector<double> values_; /*values of the current factor 0, updated by delta refactor, compared by bypass*/
+    std::vector<char> dirty_;
+    std::vector<double> rwork_; /*refinement work space, 3n values*/
+    FactorRows rows_; /*built by the first sparse solve after initialization*/
+    std::vector<SparsePlan> plans_; /*the last HOST_SPARSE_PLANS sparse solve patterns*/
+    size_t nextplan_;
+    std::vector<double> ywork_; /*sparse solve work space, kept zero*/
+    std::vector<char> mark_;
+    std::vector<double> sweep_; /*frequency sweep values and solve work space of each worker*/
+    StampPlan stamps_;
+    std::vector<double> fx_; /*factor-ordered values summed from stamps, zero at the positions no stamp reaches*/
+    int threshold_;
+    int ordering_; /*ORDER_AMD or ORDER_RCM, of the current structure*/
+    bool initialized_;
+    std::vector<char> refactorized_;
+    std::string cache_; /*directory of saved symbolic structures, empty when disabled*/
+    std::unique_ptr<Tracer> trace_; /*kept when tracing is switched off, so that it can still be dumped*/
+    Tracer *tracing_; /*trace_ while iparm[14] > 0, NULL otherwise*/
+    Counters stats_;
+};
+
+typedef HostAccelerator<__CKTSO_GPU, ICktSo, int> HostAccel;
+typedef HostAccelerator<__CKTSO_L_GPU, ICktSo_L, long long> HostAccel_L;
+
+}
+
+#endif
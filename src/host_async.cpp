@@ -0,0 +1,218 @@
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include "../cktso-gpu-host.h"
+
+namespace cktso_host
+{
+
+struct RequestState
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done;
+    int ret;
+
+    RequestState() : done(false), ret(0) {}
+};
+
+class Request : public __CKTSO_GPU_REQUEST
+{
+public:
+    explicit Request(const std::shared_ptr<RequestState> &state) : state_(state) {}
+    virtual ~Request() {}
+
+    virtual int _CDECL_ Wait()
+    {
+        int ret;
+        {
+            std::unique_lock<std::mutex> lock(state_->mutex);
+            while (!state_->done) state_->cv.wait(lock);
+            ret = state_->ret;
+        }
+        delete this;
+        return ret;
+    }
+
+    virtual int _CDECL_ Test(bool *done)
+    {
+        if (NULL == done) return -2;
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        *done = state_->done;
+        return 0;
+    }
+
+private:
+    std::shared_ptr<RequestState> state_;
+};
+
+/*
+* AsyncQueue: one worker thread executes the requests of one accelerator in submission order
+*/
+template <typename Accel>
+class AsyncQueue : public __CKTSO_GPU_ASYNC
+{
+public:
+    explicit AsyncQueue(Accel *accel) : accel_(accel), quit_(false)
+    {
+        worker_ = std::thread(&AsyncQueue::Worker, this);
+    }
+    virtual ~AsyncQueue() {}
+
+    virtual int _CDECL_ DestroyGpuAsync()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            quit_ = true;
+        }
+        cv_.notify_one();
+        worker_.join();
+        delete this;
+        return 0;
+    }
+
+    virtual int _CDECL_ GpuRefactorizeAsync(const double ax[], ICktSoGpuRequest *req)
+    {
+        if (NULL == ax) return -2;
+        Accel *accel = accel_;
+        return Submit([accel, ax]() { return accel->GpuRefactorize(ax); }, req);
+    }
+
+    virtual int _CDECL_ GpuSolveAsync(const double b[], double x[], bool row0_column1, ICktSoGpuRequest *req)
+    {
+        if (NULL == b || NULL == x) return -2;
+        Accel *accel = accel_;
+        return Submit([accel, b, x, row0_column1]() { return accel->GpuSolve(b, x, row0_column1); }, req);
+    }
+
+private:
+    struct Task
+    {
+        std::function<int()> fn;
+        std::shared_ptr<RequestState> state;
+    };
+
+    int Submit(const std::function<int()> &fn, ICktSoGpuRequest *req)
+    {
+        Task task;
+        if (req != NULL) *req = NULL;
+        try
+        {
+            task.fn = fn;
+            if (req != NULL)
+            {
+                task.state = std::make_shared<RequestState>();
+                *req = new Request(task.state);
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(task);
+        }
+        catch (const std::bad_alloc &)
+        {
+            if (req != NULL && *req != NULL)
+            {
+                delete static_cast<Request *>(*req);
+                *req = NULL;
+            }
+            return -4;
+        }
+        cv_.notify_one();
+        return 0;
+    }
+
+    void Worker()
+    {
+        for (;;)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                while (!quit_ && tasks_.empty()) cv_.wait(lock);
+                if (tasks_.empty()) return;
+                task = tasks_.front();
+                tasks_.pop_front();
+            }
+
+            const int ret = task.fn();
+            if (task.state)
+            {
+                std::lock_guard<std::mutex> lock(task.state->mutex);
+                task.state->ret = ret;
+                task.state->done = true;
+                task.state->cv.notify_all();
+            }
+        }
+    }
+
+    Accel *accel_;
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Task> tasks_;
+    bool quit_;
+};
+
+template <typename Accel>
+static int CreateAsync(ICktSoGpuAsync *async, Accel *accel)
+{
+    if (NULL == async) return -2;
+    *async = NULL;
+    if (NULL == accel) return -1;
+    try
+    {
+        *async = new AsyncQueue<Accel>(accel);
+    }
+    catch (const std::exception &)
+    {
+        return -4;
+    }
+    return 0;
+}
+
+}
+
+using namespace cktso_host;
+
+int CKTSO_CreateGpuAsync(ICktSoGpuAsync *async, ICktSoGpu accel)
+{
+    return CreateAsync(async, accel);
+}
+
+int CKTSO_L_CreateGpuAsync(ICktSoGpuAsync *async, ICktSoGpu_L accel)
+{
+    return CreateAsync(async, accel);
+}
+
+int CKTSO_DestroyGpuAsync(ICktSoGpuAsync async)
+{
+    if (NULL == async) return -1;
+    return async->DestroyGpuAsync();
+}
+
+int CKTSO_GpuRefactorizeAsync(ICktSoGpuAsync async, const double ax[], ICktSoGpuRequest *req)
+{
+    if (NULL == async) return -1;
+    return async->GpuRefactorizeAsync(ax, req);
+}
+
+int CKTSO_GpuSolveAsync(ICktSoGpuAsync async, const double b[], double x[], bool row0_column1, ICktSoGpuRequest *req)
+{
+    if (NULL == async) return -1;
+    return async->GpuSolveAsync(b, x, row0_column1, req);
+}
+
+int CKTSO_GpuWait(ICktSoGpuRequest req)
+{
+    if (NULL == req) return -1;
+    return req->Wait();
+}
+
+int CKTSO_GpuTest(ICktSoGpuRequest req, bool *done)
+{
+    if (NULL == req) return -1;
+    return req->Test(done);
+}
@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#include "host_lu.h"
+
+namespace cktso_host
+{
+
+/*
+* saved symbolic structure, native byte order:
+* SymbolicHeader, then ap (n+1), ai (nnz), q (n), pinv (n), cp (n+1), ci (fnz), dpos (n), amap (nnz), level (n), lvptr (levels+1), lvcol (n), all idx_t
+* checksum covers the header (with checksum = 0) and all arrays
+*/
+#define SYMBOLIC_VERSION 2 /*1 was ordered by reverse Cuthill-McKee only, under the file name of AMD structures*/
+
+struct SymbolicHeader
+{
+    char magic[8]; /*"CKTSOSYM"*/
+    unsigned int version;
+    unsigned int index; /*sizeof(idx_t)*/
+    long long n, nnz, fnz, levels;
+    unsigned long long hash; /*PatternHash*/
+    unsigned long long checksum;
+};
+
+static unsigned long long Hash(unsigned long long h, const SymbolicHeader &header)
+{
+    SymbolicHeader t = header;
+    t.checksum = 0;
+    unsigned long long w[sizeof(t) / sizeof(unsigned long long)];
+    memcpy(w, &t, sizeof(w));
+    for (size_t i = 0; i < sizeof(w) / sizeof(w[0]); ++i) h = HashMix(h, w[i]);
+    return h;
+}
+
+/*arrays of a saved structure, in file order*/
+static void Arrays(Symbolic &s, std::vector<idx_t> *a[11])
+{
+    a[0] = &s.ap;
+    a[1] = &s.ai;
+    a[2] = &s.q;
+    a[3] = &s.pinv;
+    a[4] = &s.cp;
+    a[5] = &s.ci;
+    a[6] = &s.dpos;
+    a[7] = &s.amap;
+    a[8] = &s.level;
+    a[9] = &s.lvptr;
+    a[10] = &s.lvcol;
+}
+
+static bool Permutation(const std::vector<idx_t> &p, std::vector<char> &seen)
+{
+    std::fill(seen.begin(), seen.end(), 0);
+    for (size_t i = 0; i < p.size(); ++i)
+    {
+        const idx_t v = p[i];
+        if (v < 0 || v >= (idx_t)seen.size() || seen[v]) return false;
+        seen[v] = 1;
+    }
+    return true;
+}
+
+/*index ranges and ordering, so that a structure that passed the checksum cannot be used out of bounds, and the levels respect the dependencies*/
+static bool Consistent(const Symbolic &s)
+{
+    const idx_t n = s.n;
+    const idx_t fnz = (idx_t)s.ci.size();
+    std::vector<char> seen(n);
+    if (!Permutation(s.q, seen) || !Permutation(s.pinv, seen) || !Permutation(s.lvcol, seen)) return false;
+    if (s.cp[0] != 0 || s.cp[n] != fnz) return false;
+    for (idx_t k = 0; k < n; ++k)
+    {
+        if (s.cp[k + 1] <= s.cp[k] || s.dpos[k] < s.cp[k] || s.dpos[k] >= s.cp[k + 1] || s.ci[s.dpos[k]] != k) return false;
+        for (idx_t p = s.cp[k]; p < s.cp[k + 1]; ++p)
+        {
+            const idx_t i = s.ci[p];
+            if (i < 0 || i >= n || (p > s.cp[k] && i <= s.ci[p - 1])) return false;
+            if (p < s.dpos[k] && s.level[i] >= s.level[k]) return false;
+        }
+    }
+    for (idx_t p = 0; p < s.nnz; ++p)
+    {
+        if (s.amap[p] < 0 || s.amap[p] >= fnz) return false;
+    }
+    const idx_t levels = s.Levels();
+    if (s.lvptr[0] != 0 || s.lvptr[levels] != n) return false;
+    for (idx_t l = 0; l < levels; ++l)
+    {
+        if (s.lvptr[l + 1] < s.lvptr[l]) return false;
+        for (idx_t i = s.lvptr[l]; i < s.lvptr[l + 1]; ++i)
+        {
+            if (s.level[s.lvcol[i]] != l) return false;
+        }
+    }
+    return true;
+}
+
+bool HostLU::Load(const char file[], bool complex, idx_t n, const idx_t ap[], const idx_t ai[])
+{
+    FILE *fp = fopen(file, "rb");
+    if (NULL == fp) return false;
+    SymbolicHeader h;
+    const idx_t nnz = ap[n];
+    bool ok = fread(&h, sizeof(h), 1, fp) == 1 && memcmp(h.magic, "CKTSOSYM", 8) == 0 && SYMBOLIC_VERSION == h.version
+        && sizeof(idx_t) == h.index && h.n == n && h.nnz == nnz && h.fnz >= n && h.levels > 0 && h.levels <= n
+        && h.hash == PatternHash(n, ap, ai);
+
+    /*the file size is checked before anything is allocated*/
+    const unsigned long long words = 7ULL * n + 3 + 2ULL * nnz + (ok ? (unsigned long long)h.fnz + h.levels : 0);
+    if (ok)
+    {
+        ok = fseek(fp, 0, SEEK_END) == 0 && (unsigned long long)ftell(fp) == sizeof(h) + words * sizeof(idx_t) && fseek(fp, (long)sizeof(h), SEEK_SET) == 0;
+    }
+
+    Symbolic s;
+    std::vector<idx_t> *arrays[11];
+    Arrays(s, arrays);
+    if (ok)
+    {
+        const size_t sizes[11] = { (size_t)n + 1, (size_t)nnz, (size_t)n, (size_t)n, (size_t)n + 1, (size_t)h.fnz, (size_t)n,
+            (size_t)nnz, (size_t)n, (size_t)h.levels + 1, (size_t)n };
+        unsigned long long sum = Hash(0xcbf29ce484222325ULL, h);
+        for (int i = 0; i < 11 && ok; ++i)
+        {
+            required_ = (long long)(sizes[i] * sizeof(idx_t));
+            arrays[i]->resize(sizes[i]);
+            ok = sizes[i] == 0 || fread(&(*arrays[i])[0], sizeof(idx_t), sizes[i], fp) == sizes[i];
+            if (ok) sum = HashArray(sum, sizes[i] == 0 ? NULL : &(*arrays[i])[0], sizes[i]);
+        }
+        ok = ok && sum == h.checksum;
+    }
+    fclose(fp);
+    if (!ok) return false;
+
+    /*a hash collision is not trusted*/
+    s.n = n;
+    s.nnz = nnz;
+    s.complex = complex;
+    if (!std::equal(ap, ap + n + 1, s.ap.begin()) || !std::equal(ai, ai + nnz, s.ai.begin()) || !Consistent(s)) return false;
+    s.qinv.resize(n);
+    for (idx_t k = 0; k < n; ++k) s.qinv[s.q[k]] = k;
+    std::swap(sym_, s);
+    return true;
+}
+
+/*process id and a process-wide counter, accelerators of one process may save the same pattern at once*/
+std::string TempName(const char file[])
+{
+    static std::atomic<unsigned long long> counter(0);
+#ifdef _WIN32
+    const int pid = _getpid();
+#else
+    const int pid = (int)getpid();
+#endif
+    return std::string(file) + "." + std::to_string(pid) + "." + std::to_string(counter++) + ".tmp";
+}
+
+bool HostLU::Save(const char file[]) const
+{
+    Symbolic &s = const_cast<Symbolic &>(sym_);
+    std::vector<idx_t> *arrays[11];
+    Arrays(s, arrays);
+    SymbolicHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "CKTSOSYM", 8);
+    h.version = SYMBOLIC_VERSION;
+    h.index = sizeof(idx_t);
+    h.n = s.n;
+    h.nnz = s.nnz;
+    h.fnz = s.FactorNnz();
+    h.levels = s.Levels();
+    h.hash = PatternHash(s.n, &s.ap[0], s.ai.empty() ? NULL : &s.ai[0]);
+    unsigned long long sum = Hash(0xcbf29ce484222325ULL, h);
+    for (int i = 0; i < 11; ++i) sum = HashArray(sum, arrays[i]->empty() ? NULL : &(*arrays[i])[0], arrays[i]->size());
+    h.checksum = sum;
+
+    /*written to a private file and renamed, so that other processes never read a partial file*/
+    const std::string tmp = TempName(file);
+    FILE *fp = fopen(tmp.c_str(), "wb");
+    if (NULL == fp) return false;
+    bool ok = fwrite(&h, sizeof(h), 1, fp) == 1;
+    for (int i = 0; i < 11 && ok; ++i)
+    {
+        ok = arrays[i]->empty() || fwrite(&(*arrays[i])[0], sizeof(idx_t), arrays[i]->size(), fp) == arrays[i]->size();
+    }
+    ok = (fclose(fp) == 0) && ok;
+#ifdef _WIN32
+    if (ok) remove(file);
+#endif
+    ok = ok && rename(tmp.c_str(), file) == 0;
+    if (!ok) remove(tmp.c_str());
+    return ok;
+}
+
+}
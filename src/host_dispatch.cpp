@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <math.h>
+#include <new>
+#include <string.h>
+#include "host_dispatch.h"
+
+namespace cktso_host
+{
+
+/*GPU-accelerators document 8 input and 7 output parms (see cktso-gpu.h)*/
+#define GPU_IPARM_USED      8
+#define GPU_OPARM_USED      7
+#define HOST_IPARM_USED     19 /*parm[15..17] are the dispatcher's, ignored by the accelerator*/
+#define HOST_OPARM_USED     19
+
+static bool IsHost(ICktSoGpu a)
+{
+    return CKTSO_IsHostAccelerator(a);
+}
+
+static bool IsHost(ICktSoGpu_L a)
+{
+    return CKTSO_L_IsHostAccelerator(a);
+}
+
+static int GetSchedule(ICktSoGpu a, CKTSO_GPU_SCHEDULE *s, long long flops[], long long size)
+{
+    return CKTSO_GpuGetSchedule(a, s, NULL, flops, size);
+}
+
+static int GetSchedule(ICktSoGpu_L a, CKTSO_GPU_SCHEDULE *s, long long flops[], long long size)
+{
+    return CKTSO_L_GpuGetSchedule(a, s, NULL, flops, size);
+}
+
+static long long Median(std::vector<long long> v)
+{
+    std::sort(v.begin(), v.end());
+    const size_t n = v.size();
+    return (n & 1) ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+template <typename Base, typename Inst>
+Dispatcher<Base, Inst>::Dispatcher(Base *device, int *diparm, const long long *doparm) :
+    device_(device), diparm_(diparm), doparm_(doparm), inst_(NULL), engine_(-1), reason_(CKTSO_DISPATCH_TRIAL), estimate_(-1),
+    calibrating_(true), chosen_(CKTSO_ENGINE_ACCELERATOR), average_(0.), open_(false), cycle_(0)
+{
+    const bool host = IsHost(device);
+    shared_ = host ? HOST_IPARM_USED : GPU_IPARM_USED;
+    reported_ = host ? HOST_OPARM_USED : GPU_OPARM_USED;
+    memset(iparm, 0, sizeof(iparm));
+    memset(oparm, 0, sizeof(oparm));
+    memcpy(iparm, diparm_, shared_ * sizeof(int));
+    iparm[16] = 3;
+    iparm[17] = 50;
+    oparm[19] = -1;
+}
+
+template <typename Base, typename Inst>
+int Dispatcher<Base, Inst>::DestroyGpuAccelerator()
+{
+    device_->DestroyGpuAccelerator();
+    delete this;
+    return 0;
+}
+
+/*the accelerator reads its own arrays, which are synchronized around each call*/
+template <typename Base, typename Inst>
+void Dispatcher<Base, Inst>::Push()
+{
+    memcpy(diparm_, iparm, shared_ * sizeof(int));
+}
+
+template <typename Base, typename Inst>
+void Dispatcher<Base, Inst>::Pull()
+{
+    memcpy(oparm, doparm_, reported_ * sizeof(long long));
+}
+
+/*
+* Estimate: from the schedule of a host accelerator, a refactor too small to amortize the accelerator's synchronization,
+* or without enough independent columns to keep its threads busy, goes to the solver without trials
+*/
+template <typename Base, typename Inst>
+void Dispatcher<Base, Inst>::Estimate()
+{
+    estimate_ = -1;
+    oparm[24] = 0;
+    oparm[25] = 0;
+    CKTSO_GPU_SCHEDULE s;
+    if (GetSchedule(device_, &s, NULL, 0) != 0) return;
+    long long tail = 0;
+    try
+    {
+        std::vector<long long> flops((size_t)s.levels);
+        if (s.levels > 0 && 0 == GetSchedule(device_, &s, &flops[0], s.levels))
+        {
+            for (long long l = s.bulk_levels; l < s.levels; ++l) tail += flops[(size_t)l];
+        }
+    }
+    catch (const std::bad_alloc &)
+    {
+    }
+    oparm[24] = (long long)floor(s.parallelism * 100. + .5);
+    oparm[25] = s.flops > 0 ? tail * 100 / s.flops : 0;
+    if (s.flops < DISPATCH_MIN_FLOPS || s.parallelism < DISPATCH_MIN_PARALLELISM) estimate_ = CKTSO_ENGINE_SOLVER;
+}
+
+template <typename Base, typename Inst>
+void Dispatcher<Base, Inst>::Calibrate()
+{
+    calibrating_ = true;
+    trials_[0].clear();
+    trials_[1].clear();
+    average_ = 0.;
+}
+
+/*ends the current cycle, as a trial, or checking the drift of the chosen engine*/
+template <typename Base, typename Inst>
+void Dispatcher<Base, Inst>::Close()
+{
+    if (!open_) return;
+    open_ = false;
+    if (CKTSO_DISPATCH_TRIAL == reason_)
+    {
+        trials_[engine_].push_back(cycle_);
+    }
+    else if (CKTSO_DISPATCH_CALIBRATED == reason_)
+    {
+        average_ = average_ > 0. ? .75 * average_ + .25 * cycle_ : (double)cycle_;
+        const long long calibrated = oparm[21 + chosen_];
+        if (average_ > calibrated * (1. + iparm[17] * .01)) Calibrate();
+    }
+}
+
+template <typename Base, typename Inst>
+int Dispatcher<Base, Inst>::Choose()
+{
+    if (iparm[15] != 0)
+    {
+        reason_ = CKTSO_DISPATCH_FORCED;
+        return 1 == iparm[15] ? CKTSO_ENGINE_SOLVER : CKTSO_ENGINE_ACCELERATOR;
+    }
+    if (estimate_ >= 0)
+    {
+        reason_ = CKTSO_DISPATCH_ESTIMATE;
+        return estimate_;
+    }
+    if (calibrating_)
+    {
+        const size_t trials = iparm[16] < 1 ? 1 : (size_t)iparm[16];
+        const size_t a = trials_[CKTSO_ENGINE_ACCELERATOR].size(), s = trials_[CKTSO_ENGINE_SOLVER].size();
+        if (a < trials || s < trials)
+        {
+            reason_ = CKTSO_DISPATCH_TRIAL;
+            return a <= s ? CKTSO_ENGINE_ACCELERATOR : CKTSO_ENGINE_SOLVER;
+        }
+        oparm[21] = Median(trials_[CKTSO_ENGINE_SOLVER]);
+        oparm[22] = Median(trials_[CKTSO_ENGINE_ACCELERATOR]);
+        chosen_ = oparm[21] <= oparm[22] ? CKTSO_ENGINE_SOLVER : CKTSO_ENGINE_ACCELERATOR;
+        calibrating_ = false;
+        ++oparm[23];
+    }
+    reason_ = CKTSO_DISPATCH_CALIBRATED;
+    return chosen_;
+}
+
+template <typename Base, typename Inst>
+int Dispatcher<Base, Inst>::InitializeGpuAccelerator(Inst inst)
+{
+    if (NULL == inst) return -1;
+    inst_ = NULL;
+    engine_ = -1;
+    open_ = false;
+    oparm[19] = -1;
+    Push();
+    const int ret = device_->InitializeGpuAccelerator(inst);
+    Pull();
+    if (ret != 0) return ret;
+    inst_ = inst;
+    Estimate();
+    Calibrate();
+    return 0;
+}
+
+template <typename Base, typename Inst>
+int Dispatcher<Base, Inst>::GpuRefactorize(const double ax[])
+{
+    if (NULL == inst_) return -52;
+    if (NULL == ax) return -2;
+    Close();
+    const int engine = Choose();
+    Timer timer(iparm[0]);
+    const long long start = Counters::Now();
+    int ret;
+    if (CKTSO_ENGINE_SOLVER == engine)
+    {
+        ret = inst_->Refactorize(ax);
+        oparm[1] = timer.Elapsed();
+    }
+    else
+    {
+        Push();
+        ret = device_->GpuRefactorize(ax);
+        Pull();
+    }
+    cycle_ = Counters::Now() - start;
+    engine_ = 0 == ret ? engine : -1;
+    open_ = (0 == ret);
+    oparm[19] = engine_;
+    oparm[20] = reason_;
+    return ret;
+}
+
+template <typename Base, typename Inst>
+int Dispatcher<Base, Inst>::GpuSolve(const double b[], double x[], bool row0_column1)
+{
+    if (NULL == inst_) return -52;
+    if (engine_ < 0) return -53;
+    if (NULL == b || NULL == x) return -2;
+    Timer timer(iparm[0]);
+    const long long start = Counters::Now();
+    int ret;
+    if (CKTSO_ENGINE_SOLVER == engine_)
+    {
+        ret = inst_->Solve(b, x, false, row0_column1);
+        oparm[2] = timer.Elapsed();
+    }
+    else
+    {
+        Push();
+        ret = device_->GpuSolve(b, x, row0_column1);
+        Pull();
+    }
+    cycle_ += Counters::Now() - start;
+    return ret;
+}
+
+template class Dispatcher<__CKTSO_GPU, ICktSo>;
+template class Dispatcher<__CKTSO_L_GPU, ICktSo_L>;
+
+template <typename Accel, typename DispatchType, typename Create>
+static int CreateDispatcher(Accel **accel, int **iparm, const long long **oparm, Create create)
+{
+    if (NULL == accel || NULL == iparm || NULL == oparm) return -2;
+    *accel = NULL;
+    Accel *device = NULL;
+    int *diparm;
+    const long long *doparm;
+    const int ret = create(&device, &diparm, &doparm);
+    if (ret != 0) return ret;
+    DispatchType *d;
+    try
+    {
+        d = new DispatchType(device, diparm, doparm);
+    }
+    catch (const std::bad_alloc &)
+    {
+        device->DestroyGpuAccelerator();
+        return -4;
+    }
+    *accel = d;
+    *iparm = d->iparm;
+    *oparm = d->oparm;
+    return 0;
+}
+
+}
+
+using namespace cktso_host;
+
+int CKTSO_CreateDispatcher(ICktSoGpu *accel, int **iparm, const long long **oparm, int gpuid)
+{
+    return CreateDispatcher<__CKTSO_GPU, Dispatch>(accel, iparm, oparm,
+        [gpuid](ICktSoGpu *a, int **ip, const long long **op) { return CKTSO_CreateAccelerator(a, ip, op, gpuid); });
+}
+
+int CKTSO_L_CreateDispatcher(ICktSoGpu_L *accel, int **iparm, const long long **oparm, int gpuid)
+{
+    return CreateDispatcher<__CKTSO_L_GPU, Dispatch_L>(accel, iparm, oparm,
+        [gpuid](ICktSoGpu_L *a, int **ip, const long long **op) { return CKTSO_L_CreateAccelerator(a, ip, op, gpuid); });
+}
@@ -0,0 +1,69 @@
+/*dispatcher between the CKTSO solver and an accelerator*/
+#ifndef __CKTSO_HOST_DISPATCH__
+#define __CKTSO_HOST_DISPATCH__
+
+#include <vector>
+#include "host_accel.h"
+
+namespace cktso_host
+{
+
+/*the accelerator is not worth a trial below these (see Estimate)*/
+#define DISPATCH_MIN_FLOPS          100000
+#define DISPATCH_MIN_PARALLELISM    1.5
+
+/*
+* Dispatcher: owns the accelerator, borrows the solver instance given to InitializeGpuAccelerator
+* A cycle is a refactor and the solves that follow it, all on the same engine, it is timed as a whole so that the choice weighs both
+*/
+template <typename Base, typename Inst>
+class Dispatcher : public Base
+{
+public:
+    Dispatcher(Base *device, int *iparm, const long long *oparm);
+    virtual ~Dispatcher() {}
+
+    virtual int _CDECL_ DestroyGpuAccelerator();
+    virtual int _CDECL_ InitializeGpuAccelerator(_IN_ Inst inst);
+    virtual int _CDECL_ GpuRefactorize(_IN_ const double ax[]);
+    virtual int _CDECL_ GpuSolve(_IN_ const double b[], _OUT_ double x[], _IN_ bool row0_column1);
+
+    Base *Device() const
+    {
+        return device_;
+    }
+
+    int iparm[HOST_IPARM_SIZE];
+    long long oparm[HOST_OPARM_SIZE];
+
+private:
+    void Push();
+    void Pull();
+    void Estimate();
+    void Calibrate();
+    void Close();
+    int Choose();
+
+    Base *device_;
+    int *diparm_;
+    const long long *doparm_;
+    int shared_; /*#input parms passed to the accelerator*/
+    int reported_; /*#output parms passed back*/
+    Inst inst_;
+    int engine_; /*engine of the current factors, -1 for none*/
+    int reason_;
+    int estimate_; /*engine settled by Estimate, -1 for none*/
+    bool calibrating_;
+    int chosen_;
+    std::vector<long long> trials_[2];
+    double average_; /*moving average of the chosen engine's cycle time*/
+    bool open_;
+    long long cycle_;
+};
+
+typedef Dispatcher<__CKTSO_GPU, ICktSo> Dispatch;
+typedef Dispatcher<__CKTSO_L_GPU, ICktSo_L> Dispatch_L;
+
+}
+
+#endif
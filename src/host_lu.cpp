@@ -0,0 +1,1766 @@
+#include <algorithm>
+#include <atomic>
+#include <complex>
+#include <functional>
+#include <limits.h>
+#include <memory>
+#include <math.h>
+#include <new>
+#include <string.h>
+#include "host_lu.h"
+
+namespace cktso_host
+{
+
+typedef std::complex<double> cplx;
+typedef std::complex<float> cplxf;
+
+size_t Symbolic::Bytes() const
+{
+    return sizeof(idx_t) * (ap.capacity() + ai.capacity() + q.capacity() + qinv.capacity() + pinv.capacity()
+        + cp.capacity() + ci.capacity() + dpos.capacity() + amap.capacity()
+        + level.capacity() + lvptr.capacity() + lvcol.capacity());
+}
+
+/*real operations of a full refactor, a multiply-add per L entry and U entry pair, a division per L entry, complex ones counting as 4*/
+long long Symbolic::ColumnFlops(idx_t k) const
+{
+    long long f = cp[k + 1] - dpos[k] - 1;
+    for (idx_t p = cp[k]; p < dpos[k]; ++p)
+    {
+        const idx_t j = ci[p];
+        f += 2 * (cp[j + 1] - dpos[j] - 1);
+    }
+    return complex ? 4 * f : f;
+}
+
+long long Symbolic::Flops() const
+{
+    long long f = 0;
+    for (idx_t k = 0; k < n; ++k) f += ColumnFlops(k);
+    return f;
+}
+
+template <typename V>
+void HostLU::Resize(V &v, size_t size)
+{
+    required_ = (long long)(size * sizeof(v[0]));
+    v.resize(size);
+}
+
+/*column ordering on the pattern of B + B^T, without the diagonal*/
+void HostLU::Order(int ordering)
+{
+    const idx_t n = sym_.n;
+    const idx_t *ap = &sym_.ap[0];
+    const idx_t *ai = sym_.ai.empty() ? NULL : &sym_.ai[0];
+
+    std::vector<idx_t> xadj, adj;
+    Resize(xadj, n + 1);
+    for (idx_t c = 0; c < n; ++c)
+    {
+        for (idx_t p = ap[c]; p < ap[c + 1]; ++p)
+        {
+            const idx_t r = ai[p];
+            if (r != c)
+            {
+                ++xadj[c + 1];
+                ++xadj[r + 1];
+            }
+        }
+    }
+    for (idx_t i = 0; i < n; ++i) xadj[i + 1] += xadj[i];
+    Resize(adj, xadj[n]);
+    std::vector<idx_t> pos(xadj.begin(), xadj.end() - 1);
+    for (idx_t c = 0; c < n; ++c)
+    {
+        for (idx_t p = ap[c]; p < ap[c + 1]; ++p)
+        {
+            const idx_t r = ai[p];
+            if (r != c)
+            {
+                adj[pos[c]++] = r;
+                adj[pos[r]++] = c;
+            }
+        }
+    }
+
+    /*remove duplicated edges*/
+    idx_t nz = 0;
+    for (idx_t i = 0; i < n; ++i)
+    {
+        const idx_t start = xadj[i];
+        const idx_t end = xadj[i + 1];
+        std::sort(adj.begin() + start, adj.begin() + end);
+        xadj[i] = nz;
+        for (idx_t p = start; p < end; ++p)
+        {
+            if (p == start || adj[p] != adj[p - 1]) adj[nz++] = adj[p];
+        }
+    }
+    xadj[n] = nz;
+
+    if (ORDER_RCM == ordering) Rcm(xadj, adj);
+    else Amd(xadj, adj);
+}
+
+/*reverse Cuthill-McKee, a narrow band but no fill reduction*/
+void HostLU::Rcm(const std::vector<idx_t> &xadj, const std::vector<idx_t> &adj)
+{
+    const idx_t n = sym_.n;
+    std::vector<idx_t> deg;
+    Resize(deg, n);
+    for (idx_t i = 0; i < n; ++i) deg[i] = xadj[i + 1] - xadj[i];
+
+    std::vector<idx_t> &q = sym_.q;
+    Resize(q, n);
+    std::vector<idx_t> mark(n, -1);
+    std::vector<char> visited(n, 0);
+    struct ByDegree
+    {
+        const idx_t *deg;
+        bool operator()(idx_t a, idx_t b) const
+        {
+            return deg[a] < deg[b] || (deg[a] == deg[b] && a < b);
+        }
+    } by_degree = { &deg[0] };
+
+    /*breadth-first search inside one component, returns eccentricity and the start of the last level in q*/
+    idx_t stamp = 0;
+    idx_t head = 0;
+    idx_t last = 0;
+    idx_t next = 0;
+    idx_t seek = 0;
+    while (next < n)
+    {
+        while (visited[seek]) ++seek;
+        idx_t root = seek;
+
+        /*pseudo-peripheral root*/
+        idx_t ecc = -1;
+        for (int iter = 0; iter < 8; ++iter)
+        {
+            ++stamp;
+            head = next;
+            idx_t tail = next;
+            q[tail++] = root;
+            mark[root] = stamp;
+            idx_t depth = 0;
+            last = head;
+            while (head < tail)
+            {
+                const idx_t level_end = tail;
+                last = head;
+                while (head < level_end)
+                {
+                    const idx_t v = q[head++];
+                    for (idx_t p = xadj[v]; p < xadj[v + 1]; ++p)
+                    {
+                        const idx_t u = adj[p];
+                        if (mark[u] != stamp && !visited[u])
+                        {
+                            mark[u] = stamp;
+                            q[tail++] = u;
+                        }
+                    }
+                }
+                if (tail > level_end) ++depth;
+            }
+            if (depth <= ecc) break;
+            ecc = depth;
+            root = *std::min_element(q.begin() + last, q.begin() + tail, by_degree);
+        }
+
+        /*Cuthill-McKee numbering of the component*/
+        idx_t tail = next;
+        q[tail++] = root;
+        visited[root] = 1;
+        head = next;
+        while (head < tail)
+        {
+            const idx_t v = q[head++];
+            const idx_t start = tail;
+            for (idx_t p = xadj[v]; p < xadj[v + 1]; ++p)
+            {
+                const idx_t u = adj[p];
+                if (!visited[u])
+                {
+                    visited[u] = 1;
+                    q[tail++] = u;
+                }
+            }
+            std::sort(q.begin() + start, q.begin() + tail, by_degree);
+        }
+        next = tail;
+    }
+    std::reverse(q.begin(), q.end());
+}
+
+#define AMD_FLIP(i) (-(i) - 2)
+
+/*w[] entries of live elements are reset to 1 when mark + lemax could overflow*/
+static idx_t AmdClear(idx_t mark, idx_t lemax, idx_t w[], idx_t n)
+{
+    if (mark < 2 || mark >= LLONG_MAX / 2 - lemax)
+    {
+        for (idx_t k = 0; k < n; ++k)
+        {
+            if (w[k] != 0) w[k] = 1;
+        }
+        mark = 2;
+    }
+    return mark;
+}
+
+/*postorder of the subtree of j, children in head/next lists, returns the next position in post*/
+static idx_t AmdPostorder(idx_t j, idx_t k, idx_t head[], const idx_t next[], idx_t post[], idx_t stack[])
+{
+    idx_t top = 0;
+    stack[0] = j;
+    while (top >= 0)
+    {
+        const idx_t p = stack[top];
+        const idx_t i = head[p];
+        if (-1 == i)
+        {
+            --top;
+            post[k++] = p;
+        }
+        else
+        {
+            head[p] = next[i];
+            stack[++top] = i;
+        }
+    }
+    return k;
+}
+
+/*
+* approximate minimum degree (Amestoy, Davis and Duff) on the quotient graph, with element absorption, supervariables and mass elimination
+* Nodes denser than 10 sqrt(n) are absorbed into a virtual element n, hence ordered last. The assembly tree is postordered
+* ci is xadj/adj with elbow room, each node or element e is ci[cp[e] ... cp[e] + len[e] - 1], its elen[e] elements first
+*/
+void HostLU::Amd(std::vector<idx_t> &xadj, std::vector<idx_t> &adj)
+{
+    const idx_t n = sym_.n;
+    idx_t cnz = xadj[n];
+    const idx_t nzmax = cnz + cnz / 5 + 2 * n;
+    Resize(adj, nzmax);
+    std::vector<idx_t> ws, post;
+    Resize(ws, 8 * ((size_t)n + 1));
+    Resize(post, n + 1);
+    idx_t *cp = &xadj[0];
+    idx_t *ci = &adj[0];
+    idx_t *len = &ws[0];
+    idx_t *nv = len + (n + 1);
+    idx_t *next = nv + (n + 1);
+    idx_t *head = next + (n + 1);
+    idx_t *elen = head + (n + 1);
+    idx_t *degree = elen + (n + 1);
+    idx_t *w = degree + (n + 1);
+    idx_t *hhead = w + (n + 1);
+    idx_t *last = &post[0];
+
+    idx_t dense = (idx_t)(10. * sqrt((double)n));
+    if (dense < 16) dense = 16;
+    if (dense > n - 2) dense = n - 2;
+
+    for (idx_t k = 0; k < n; ++k) len[k] = cp[k + 1] - cp[k];
+    len[n] = 0;
+    for (idx_t i = 0; i <= n; ++i)
+    {
+        head[i] = -1;
+        last[i] = -1;
+        next[i] = -1;
+        hhead[i] = -1;
+        nv[i] = 1;
+        w[i] = 1;
+        elen[i] = 0;
+        degree[i] = len[i];
+    }
+    idx_t mark = AmdClear(0, 0, w, n);
+    elen[n] = -2;
+    cp[n] = -1;
+    w[n] = 0;
+
+    /*degree lists, empty nodes are eliminated at once and dense ones absorbed into n*/
+    idx_t nel = 0;
+    for (idx_t i = 0; i < n; ++i)
+    {
+        const idx_t d = degree[i];
+        if (0 == d)
+        {
+            elen[i] = -2;
+            ++nel;
+            cp[i] = -1;
+            w[i] = 0;
+        }
+        else if (d > dense)
+        {
+            nv[i] = 0;
+            elen[i] = -1;
+            ++nel;
+            cp[i] = AMD_FLIP(n);
+            ++nv[n];
+        }
+        else
+        {
+            if (head[d] != -1) last[head[d]] = i;
+            next[i] = head[d];
+            head[d] = i;
+        }
+    }
+
+    idx_t mindeg = 0, lemax = 0;
+    while (nel < n)
+    {
+        /*node of minimum approximate degree*/
+        idx_t k = -1;
+        for (; mindeg < n && (k = head[mindeg]) == -1; ++mindeg);
+        if (next[k] != -1) last[next[k]] = -1;
+        head[mindeg] = next[k];
+        const idx_t elenk = elen[k];
+        idx_t nvk = nv[k];
+        nel += nvk;
+
+        /*compaction of ci when the new element may not fit*/
+        if (elenk > 0 && cnz + mindeg >= nzmax)
+        {
+            for (idx_t j = 0; j < n; ++j)
+            {
+                const idx_t p = cp[j];
+                if (p >= 0)
+                {
+                    cp[j] = ci[p];
+                    ci[p] = AMD_FLIP(j);
+                }
+            }
+            idx_t q = 0;
+            for (idx_t p = 0; p < cnz;)
+            {
+                const idx_t j = AMD_FLIP(ci[p++]);
+                if (j >= 0)
+                {
+                    ci[q] = cp[j];
+                    cp[j] = q++;
+                    for (idx_t t = 0; t < len[j] - 1; ++t) ci[q++] = ci[p++];
+                }
+            }
+            cnz = q;
+        }
+
+        /*new element Lk, the union of the nodes of k and of its elements, which are absorbed*/
+        idx_t dk = 0;
+        nv[k] = -nvk;
+        idx_t p = cp[k];
+        const idx_t pk1 = (0 == elenk) ? p : cnz;
+        idx_t pk2 = pk1;
+        for (idx_t k1 = 1; k1 <= elenk + 1; ++k1)
+        {
+            idx_t e, pj, ln;
+            if (k1 > elenk)
+            {
+                e = k;
+                pj = p;
+                ln = len[k] - elenk;
+            }
+            else
+            {
+                e = ci[p++];
+                pj = cp[e];
+                ln = len[e];
+            }
+            for (idx_t k2 = 1; k2 <= ln; ++k2)
+            {
+                const idx_t i = ci[pj++];
+                const idx_t nvi = nv[i];
+                if (nvi <= 0) continue;
+                dk += nvi;
+                nv[i] = -nvi;
+                ci[pk2++] = i;
+                if (next[i] != -1) last[next[i]] = last[i];
+                if (last[i] != -1) next[last[i]] = next[i];
+                else head[degree[i]] = next[i];
+            }
+            if (e != k)
+            {
+                cp[e] = AMD_FLIP(k);
+                w[e] = 0;
+            }
+        }
+        if (elenk != 0) cnz = pk2;
+        degree[k] = dk;
+        cp[k] = pk1;
+        len[k] = pk2 - pk1;
+        elen[k] = -2;
+
+        /*|Le \ Lk| of the elements of the nodes in Lk*/
+        mark = AmdClear(mark, lemax, w, n);
+        for (idx_t pk = pk1; pk < pk2; ++pk)
+        {
+            const idx_t i = ci[pk];
+            const idx_t eln = elen[i];
+            if (eln <= 0) continue;
+            const idx_t nvi = -nv[i];
+            const idx_t wnvi = mark - nvi;
+            for (idx_t t = cp[i]; t <= cp[i] + eln - 1; ++t)
+            {
+                const idx_t e = ci[t];
+                if (w[e] >= mark) w[e] -= nvi;
+                else if (w[e] != 0) w[e] = degree[e] + wnvi;
+            }
+        }
+
+        /*approximate degrees, aggressive absorption of elements inside Lk, and hashes of the nodes for supervariable detection*/
+        for (idx_t pk = pk1; pk < pk2; ++pk)
+        {
+            const idx_t i = ci[pk];
+            const idx_t p1 = cp[i];
+            const idx_t p2 = p1 + elen[i] - 1;
+            idx_t pn = p1;
+            idx_t h = 0, d = 0;
+            for (idx_t t = p1; t <= p2; ++t)
+            {
+                const idx_t e = ci[t];
+                if (w[e] != 0)
+                {
+                    const idx_t dext = w[e] - mark;
+                    if (dext > 0)
+                    {
+                        d += dext;
+                        ci[pn++] = e;
+                        h += e;
+                    }
+                    else
+                    {
+                        cp[e] = AMD_FLIP(k);
+                        w[e] = 0;
+                    }
+                }
+            }
+            elen[i] = pn - p1 + 1;
+            const idx_t p3 = pn;
+            const idx_t p4 = p1 + len[i];
+            for (idx_t t = p2 + 1; t < p4; ++t)
+            {
+                const idx_t j = ci[t];
+                const idx_t nvj = nv[j];
+                if (nvj <= 0) continue;
+                d += nvj;
+                ci[pn++] = j;
+                h += j;
+            }
+            if (0 == d)
+            {
+                /*mass elimination*/
+                cp[i] = AMD_FLIP(k);
+                const idx_t nvi = -nv[i];
+                dk -= nvi;
+                nvk += nvi;
+                nel += nvi;
+                nv[i] = 0;
+                elen[i] = -1;
+            }
+            else
+            {
+                degree[i] = std::min(degree[i], d);
+                ci[pn] = ci[p3];
+                ci[p3] = ci[p1];
+                ci[p1] = k;
+                len[i] = pn - p1 + 1;
+                h %= n;
+                next[i] = hhead[h];
+                hhead[h] = i;
+                last[i] = h;
+            }
+        }
+        degree[k] = dk;
+        lemax = std::max(lemax, dk);
+        mark = AmdClear(mark + lemax, lemax, w, n);
+
+        /*supervariables: nodes of Lk with the same hash are compared, identical ones are absorbed*/
+        for (idx_t pk = pk1; pk < pk2; ++pk)
+        {
+            idx_t i = ci[pk];
+            if (nv[i] >= 0) continue;
+            const idx_t h = last[i];
+            i = hhead[h];
+            hhead[h] = -1;
+            for (; i != -1 && next[i] != -1; i = next[i], ++mark)
+            {
+                const idx_t ln = len[i];
+                const idx_t eln = elen[i];
+                for (idx_t t = cp[i] + 1; t <= cp[i] + ln - 1; ++t) w[ci[t]] = mark;
+                idx_t jlast = i;
+                for (idx_t j = next[i]; j != -1;)
+                {
+                    bool ok = (len[j] == ln) && (elen[j] == eln);
+                    for (idx_t t = cp[j] + 1; ok && t <= cp[j] + ln - 1; ++t)
+                    {
+                        if (w[ci[t]] != mark) ok = false;
+                    }
+                    if (ok)
+                    {
+                        cp[j] = AMD_FLIP(i);
+                        nv[i] += nv[j];
+                        nv[j] = 0;
+                        elen[j] = -1;
+                        j = next[j];
+                        next[jlast] = j;
+                    }
+                    else
+                    {
+                        jlast = j;
+                        j = next[j];
+                    }
+                }
+            }
+        }
+
+        /*external degrees of the nodes of Lk, which go back to the degree lists*/
+        p = pk1;
+        for (idx_t pk = pk1; pk < pk2; ++pk)
+        {
+            const idx_t i = ci[pk];
+            const idx_t nvi = -nv[i];
+            if (nvi <= 0) continue;
+            nv[i] = nvi;
+            idx_t d = degree[i] + dk - nvi;
+            d = std::min(d, n - nel - nvi);
+            if (head[d] != -1) last[head[d]] = i;
+            next[i] = head[d];
+            last[i] = -1;
+            head[d] = i;
+            mindeg = std::min(mindeg, d);
+            degree[i] = d;
+            ci[p++] = i;
+        }
+        nv[k] = nvk;
+        if ((len[k] = p - pk1) == 0)
+        {
+            cp[k] = -1;
+            w[k] = 0;
+        }
+        if (elenk != 0) cnz = p;
+    }
+
+    /*postorder of the assembly tree, absorbed nodes follow their parents' lists*/
+    for (idx_t i = 0; i < n; ++i) cp[i] = AMD_FLIP(cp[i]);
+    for (idx_t j = 0; j <= n; ++j) head[j] = -1;
+    for (idx_t j = n; j >= 0; --j)
+    {
+        if (nv[j] > 0) continue;
+        next[j] = head[cp[j]];
+        head[cp[j]] = j;
+    }
+    for (idx_t e = n; e >= 0; --e)
+    {
+        if (nv[e] <= 0) continue;
+        if (cp[e] != -1)
+        {
+            next[e] = head[cp[e]];
+            head[cp[e]] = e;
+        }
+    }
+    idx_t k = 0;
+    for (idx_t i = 0; i <= n; ++i)
+    {
+        if (-1 == cp[i]) k = AmdPostorder(i, k, head, next, &post[0], w);
+    }
+
+    /*the virtual element n comes last*/
+    std::vector<idx_t> &q = sym_.q;
+    Resize(q, n);
+    for (idx_t j = 0, t = 0; j <= n; ++j)
+    {
+        if (post[j] != n) q[t++] = post[j];
+    }
+}
+
+/*level of a column is one more than the deepest column of its U part, levels of columns before start are kept*/
+void HostLU::Levels(idx_t start)
+{
+    const idx_t n = sym_.n;
+    std::vector<idx_t> &level = sym_.level;
+    Resize(level, n);
+    idx_t depth = 0;
+    for (idx_t k = 0; k < start; ++k)
+    {
+        if (level[k] + 1 > depth) depth = level[k] + 1;
+    }
+    for (idx_t k = start; k < n; ++k)
+    {
+        idx_t lv = 0;
+        for (idx_t p = sym_.cp[k]; p < sym_.dpos[k]; ++p)
+        {
+            const idx_t l = level[sym_.ci[p]] + 1;
+            if (l > lv) lv = l;
+        }
+        level[k] = lv;
+        if (lv + 1 > depth) depth = lv + 1;
+    }
+
+    std::vector<idx_t> &lvptr = sym_.lvptr;
+    std::vector<idx_t> &lvcol = sym_.lvcol;
+    Resize(lvptr, depth + 1);
+    std::fill(lvptr.begin(), lvptr.end(), 0);
+    Resize(lvcol, n);
+    for (idx_t k = 0; k < n; ++k) ++lvptr[level[k] + 1];
+    for (idx_t l = 0; l < depth; ++l) lvptr[l + 1] += lvptr[l];
+    std::vector<idx_t> pos(lvptr.begin(), lvptr.end() - 1);
+    for (idx_t k = 0; k < n; ++k) lvcol[pos[level[k]]++] = k;
+}
+
+void HostLU::Schedule(int threshold)
+{
+    const idx_t levels = sym_.Levels();
+    idx_t l = 0;
+    if (threshold <= 0) threshold = 1;
+    while (l < levels && sym_.lvptr[l + 1] - sym_.lvptr[l] >= threshold) ++l;
+    sym_.nbulk = l;
+}
+
+static inline double Magnitude(double v)
+{
+    return v < 0. ? -v : v;
+}
+
+static inline double Magnitude(const cplx &v)
+{
+    return std::abs(v);
+}
+
+/*
+* columns before start keep their pivots and structure, with the values already refactorized in lu,
+* the others are pivoted again (start = 0 for a full factorization)
+*/
+template <typename T>
+int HostLU::FactorizeT(const T ax[], double tol, std::vector<double> &lu, idx_t start)
+{
+    const idx_t n = sym_.n;
+    const idx_t *ap = &sym_.ap[0];
+    const idx_t *ai = sym_.ai.empty() ? NULL : &sym_.ai[0];
+    const idx_t *q = &sym_.q[0];
+    std::vector<idx_t> &pinv = sym_.pinv;
+
+    /*left-looking LU with partial pivoting, L rows are B row indices until all pivots are known*/
+    std::vector<idx_t> lp, li, up, ui;
+    std::vector<T> lx, ux, x;
+    std::vector<idx_t> xi, stack, pstack, mark;
+    Resize(lp, n + 1);
+    Resize(up, n + 1);
+    Resize(x, n);
+    Resize(xi, n);
+    Resize(stack, n);
+    Resize(pstack, n);
+    Resize(mark, n);
+    std::fill(mark.begin(), mark.end(), -1);
+    const size_t guess = std::max((size_t)sym_.nnz * 2, (size_t)(start > 0 ? sym_.FactorNnz() : 0)) + (size_t)n;
+    required_ = (long long)(guess * (sizeof(idx_t) + sizeof(T)) * 2);
+    li.reserve(guess);
+    lx.reserve(guess);
+    ui.reserve(guess);
+    ux.reserve(guess);
+    if (0 == start)
+    {
+        Resize(pinv, n);
+        std::fill(pinv.begin(), pinv.end(), -1);
+    }
+    else
+    {
+        /*kept columns go back to the working form, L rows as B row indices, rows pivoted from start on are free again*/
+        std::vector<idx_t> prow(n);
+        for (idx_t i = 0; i < n; ++i) prow[pinv[i]] = i;
+        for (idx_t i = 0; i < n; ++i)
+        {
+            if (pinv[i] >= start) pinv[i] = -1;
+        }
+        const idx_t *cp = &sym_.cp[0];
+        const idx_t *ci = &sym_.ci[0];
+        const idx_t *dpos = &sym_.dpos[0];
+        const T *v = (const T *)&lu[0];
+        for (idx_t j = 0; j < start; ++j)
+        {
+            lp[j] = (idx_t)li.size();
+            up[j] = (idx_t)ui.size();
+            for (idx_t p = cp[j]; p <= dpos[j]; ++p)
+            {
+                ui.push_back(ci[p]);
+                ux.push_back(v[p]);
+            }
+            li.push_back(prow[j]);
+            lx.push_back(T(1.));
+            for (idx_t p = dpos[j] + 1; p < cp[j + 1]; ++p)
+            {
+                li.push_back(prow[ci[p]]);
+                lx.push_back(v[p]);
+            }
+        }
+    }
+
+    for (idx_t k = start; k < n; ++k)
+    {
+        lp[k] = (idx_t)li.size();
+        up[k] = (idx_t)ui.size();
+        const idx_t col = q[k];
+
+        /*reach of B(:, col) in the graph of L, in topological order xi[top ... n-1]*/
+        idx_t top = n;
+        for (idx_t p = ap[col]; p < ap[col + 1]; ++p)
+        {
+            const idx_t root = ai[p];
+            if (mark[root] == k) continue;
+            idx_t head = 0;
+            stack[0] = root;
+            while (head >= 0)
+            {
+                const idx_t j = stack[head];
+                const idx_t jj = pinv[j];
+                if (mark[j] != k)
+                {
+                    mark[j] = k;
+                    pstack[head] = jj < 0 ? 0 : lp[jj] + 1;
+                }
+                const idx_t end = jj < 0 ? 0 : lp[jj + 1];
+                bool done = true;
+                for (idx_t t = pstack[head]; t < end; ++t)
+                {
+                    const idx_t i = li[t];
+                    if (mark[i] == k) continue;
+                    pstack[head] = t + 1;
+                    stack[++head] = i;
+                    done = false;
+                    break;
+                }
+                if (done)
+                {
+                    --head;
+                    xi[--top] = j;
+                }
+            }
+        }
+
+        /*sparse triangular solve*/
+        for (idx_t p = top; p < n; ++p) x[xi[p]] = T(0.);
+        for (idx_t p = ap[col]; p < ap[col + 1]; ++p) x[ai[p]] += ax[p];
+        for (idx_t p = top; p < n; ++p)
+        {
+            const idx_t j = xi[p];
+            const idx_t jj = pinv[j];
+            if (jj < 0) continue;
+            const T xj = x[j];
+            for (idx_t t = lp[jj] + 1; t < lp[jj + 1]; ++t) x[li[t]] -= lx[t] * xj;
+        }
+
+        /*pivot selection, the diagonal is preferred*/
+        idx_t ipiv = -1;
+        double a = -1.;
+        for (idx_t p = top; p < n; ++p)
+        {
+            const idx_t i = xi[p];
+            if (pinv[i] < 0)
+            {
+                const double t = Magnitude(x[i]);
+                if (t > a)
+                {
+                    a = t;
+                    ipiv = i;
+                }
+            }
+            else
+            {
+                ui.push_back(pinv[i]);
+                ux.push_back(x[i]);
+            }
+        }
+        if (ipiv < 0 || a <= 0.) return -6;
+        if (pinv[col] < 0 && mark[col] == k && Magnitude(x[col]) >= a * tol) ipiv = col;
+
+        const T pivot = x[ipiv];
+        ui.push_back(k);
+        ux.push_back(pivot);
+        pinv[ipiv] = k;
+        li.push_back(ipiv);
+        lx.push_back(T(1.));
+        for (idx_t p = top; p < n; ++p)
+        {
+            const idx_t i = xi[p];
+            if (pinv[i] < 0)
+            {
+                li.push_back(i);
+                lx.push_back(x[i] / pivot);
+            }
+            x[i] = T(0.);
+        }
+    }
+    lp[n] = (idx_t)li.size();
+    up[n] = (idx_t)ui.size();
+
+    /*merge U and L into factor columns with ascending factor rows*/
+    const idx_t fnz = up[n] + lp[n] - n;
+    std::vector<idx_t> &cp = sym_.cp;
+    std::vector<idx_t> &ci = sym_.ci;
+    std::vector<idx_t> &dpos = sym_.dpos;
+    Resize(cp, n + 1);
+    Resize(ci, fnz);
+    Resize(dpos, n);
+    Resize(lu, (sizeof(T) / sizeof(double)) * fnz);
+    T *v = (T *)&lu[0];
+    std::vector<std::pair<idx_t, T> > col;
+    idx_t nz = 0;
+    for (idx_t k = 0; k < n; ++k)
+    {
+        cp[k] = nz;
+        col.clear();
+        for (idx_t p = up[k]; p < up[k + 1]; ++p) col.push_back(std::make_pair(ui[p], ux[p]));
+        for (idx_t p = lp[k] + 1; p < lp[k + 1]; ++p) col.push_back(std::make_pair(pinv[li[p]], lx[p]));
+        std::sort(col.begin(), col.end(), [](const std::pair<idx_t, T> &a, const std::pair<idx_t, T> &b) { return a.first < b.first; });
+        for (size_t t = 0; t < col.size(); ++t)
+        {
+            if (col[t].first == k) dpos[k] = nz;
+            ci[nz] = col[t].first;
+            v[nz] = col[t].second;
+            ++nz;
+        }
+    }
+    cp[n] = nz;
+
+    std::vector<idx_t> &qinv = sym_.qinv;
+    Resize(qinv, n);
+    for (idx_t k = 0; k < n; ++k) qinv[q[k]] = k;
+
+    /*map of matrix nonzeros into factor columns*/
+    std::vector<idx_t> &amap = sym_.amap;
+    Resize(amap, sym_.nnz);
+    for (idx_t k = 0; k < n; ++k)
+    {
+        const idx_t c = q[k];
+        for (idx_t p = ap[c]; p < ap[c + 1]; ++p)
+        {
+            const idx_t r = pinv[ai[p]];
+            amap[p] = std::lower_bound(ci.begin() + cp[k], ci.begin() + cp[k + 1], r) - ci.begin();
+        }
+    }
+
+    Levels(start);
+    return 0;
+}
+
+int HostLU::Factorize(bool complex, idx_t n, const idx_t ap[], const idx_t ai[], const double ax[], double tol, int ordering, std::vector<double> &lu)
+{
+    if (n <= 0 || ap[0] != 0) return -3;
+    for (idx_t i = 0; i < n; ++i)
+    {
+        if (ap[i + 1] < ap[i]) return -3;
+    }
+    const idx_t nnz = ap[n];
+    for (idx_t p = 0; p < nnz; ++p)
+    {
+        if (ai[p] < 0 || ai[p] >= n) return -3;
+    }
+
+    sym_.n = n;
+    sym_.nnz = nnz;
+    sym_.complex = complex;
+    sym_.ap.assign(ap, ap + n + 1);
+    sym_.ai.assign(ai, ai + nnz);
+    sym_.nbulk = 0;
+    Order(ordering);
+
+    return complex ? FactorizeT<cplx>((const cplx *)ax, tol, lu, 0) : FactorizeT<double>(ax, tol, lu, 0);
+}
+
+int HostLU::Repivot(const double ax[], double tol, std::vector<double> &lu, double work[], ThreadPool &pool, int threads, idx_t &repivoted)
+{
+    const idx_t n = sym_.n;
+    Resize(lu, (sym_.complex ? 2 : 1) * (size_t)sym_.FactorNnz());
+    Refactorize(ax, &lu[0], work, pool, threads);
+    const idx_t start = FirstBadPivot(&lu[0], tol);
+    repivoted = n - start;
+    if (start == n) return 0;
+    return sym_.complex ? FactorizeT<cplx>((const cplx *)ax, tol, lu, start) : FactorizeT<double>(ax, tol, lu, start);
+}
+
+/*left-looking refactorization of one factor column, returns false for a zero pivot*/
+template <typename T, typename F>
+bool HostLU::Column(idx_t k, const T ax[], F lu[], T w[], bool ordered) const
+{
+    const idx_t *cp = &sym_.cp[0];
+    const idx_t *ci = &sym_.ci[0];
+    const idx_t *dpos = &sym_.dpos[0];
+
+    if (ordered)
+    {
+        /*ax is in factor storage order, zero at fill-ins*/
+        const idx_t fend = cp[k + 1];
+        for (idx_t p = cp[k]; p < fend; ++p) w[ci[p]] = ax[p];
+    }
+    else
+    {
+        const idx_t *amap = &sym_.amap[0];
+        const idx_t c = sym_.q[k];
+        const idx_t aend = sym_.ap[c + 1];
+        for (idx_t p = sym_.ap[c]; p < aend; ++p) w[ci[amap[p]]] += ax[p];
+    }
+
+    const idx_t d = dpos[k];
+    for (idx_t p = cp[k]; p < d; ++p)
+    {
+        const idx_t j = ci[p];
+        const T ujk = w[j];
+        w[j] = T(0.);
+        lu[p] = ujk;
+        if (ujk == T(0.)) continue;
+        const idx_t end = cp[j + 1];
+        for (idx_t t = dpos[j] + 1; t < end; ++t) w[ci[t]] -= T(lu[t]) * ujk;
+    }
+
+    const T pivot = w[k];
+    w[k] = T(0.);
+    lu[d] = pivot;
+    const idx_t end = cp[k + 1];
+    for (idx_t p = d + 1; p < end; ++p)
+    {
+        const idx_t i = ci[p];
+        lu[p] = w[i] / pivot;
+        w[i] = T(0.);
+    }
+    return pivot != T(0.);
+}
+
+template <typename T, typename F>
+int HostLU::RefactorizeT(const T ax[], F lu[], T work[], ThreadPool &pool, int threads, const char dirty[], bool ordered) const
+{
+    const idx_t n = sym_.n;
+    const idx_t levels = sym_.Levels();
+    if (threads > pool.Threads()) threads = pool.Threads();
+    if (threads <= 1 || levels == n)
+    {
+        TraceSpan span(trace_, "sequential refactor");
+        bool ok = true;
+        for (idx_t k = 0; k < n; ++k)
+        {
+            if (NULL == dirty || dirty[k]) ok &= Column(k, ax, lu, work, ordered);
+        }
+        return ok ? 0 : -6;
+    }
+
+    const idx_t *cp = &sym_.cp[0];
+    const idx_t *ci = &sym_.ci[0];
+    const idx_t *dpos = &sym_.dpos[0];
+    const idx_t *lvptr = &sym_.lvptr[0];
+    const idx_t *lvcol = &sym_.lvcol[0];
+    const idx_t nbulk = sym_.nbulk;
+    const idx_t pstart = lvptr[nbulk];
+    std::unique_ptr<std::atomic<char>[]> done(new std::atomic<char>[n]);
+    for (idx_t k = 0; k < n; ++k) done[k].store(NULL == dirty || dirty[k] ? 0 : 1, std::memory_order_relaxed);
+    std::atomic<idx_t> next(pstart);
+    std::atomic<bool> ok(true);
+    SpinBarrier barrier(threads);
+
+    pool.Run(threads, [&](int tid)
+    {
+        T *w = work + (size_t)tid * n;
+        bool good = true;
+
+        /*bulk mode: wide levels, columns of one level are independent*/
+        for (idx_t l = 0; l < nbulk; ++l)
+        {
+            {
+                TraceSpan span(trace_, "bulk level", tid, "level", l);
+                for (idx_t i = lvptr[l] + tid; i < lvptr[l + 1]; i += threads)
+                {
+                    const idx_t k = lvcol[i];
+                    if (NULL == dirty || dirty[k]) good &= Column(k, ax, lu, w, ordered);
+                }
+            }
+            barrier.Wait();
+        }
+
+        /*pipeline mode: columns are taken in level order and wait for their own dependencies only*/
+        TraceSpan span(trace_, "pipeline", tid, "first level", nbulk);
+        for (;;)
+        {
+            const idx_t i = next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= n) break;
+            const idx_t k = lvcol[i];
+            if (dirty != NULL && !dirty[k]) continue;
+            for (idx_t p = cp[k]; p < dpos[k]; ++p)
+            {
+                const idx_t j = ci[p];
+                if (sym_.level[j] < nbulk) continue;
+                while (!done[j].load(std::memory_order_acquire)) std::this_thread::yield();
+            }
+            good &= Column(k, ax, lu, w, ordered);
+            done[k].store(1, std::memory_order_release);
+        }
+
+        if (!good) ok.store(false, std::memory_order_relaxed);
+    });
+
+    return ok.load() ? 0 : -6;
+}
+
+int HostLU::RefactorizeSequential(const double ax[], double lu[], double work[]) const
+{
+    bool ok = true;
+    if (sym_.complex)
+    {
+        for (idx_t k = 0; k < sym_.n; ++k) ok &= Column(k, (const cplx *)ax, (cplx *)lu, (cplx *)work);
+    }
+    else
+    {
+        for (idx_t k = 0; k < sym_.n; ++k) ok &= Column(k, ax, lu, work);
+    }
+    return ok ? 0 : -6;
+}
+
+int HostLU::RefactorizeSequential(const double ax[], float lu[], double work[]) const
+{
+    bool ok = true;
+    if (sym_.complex)
+    {
+        for (idx_t k = 0; k < sym_.n; ++k) ok &= Column(k, (const cplx *)ax, (cplxf *)lu, (cplx *)work);
+    }
+    else
+    {
+        for (idx_t k = 0; k < sym_.n; ++k) ok &= Column(k, ax, lu, work);
+    }
+    return ok ? 0 : -6;
+}
+
+int HostLU::Refactorize(const double ax[], double lu[], double work[], ThreadPool &pool, int threads, const char dirty[]) const
+{
+    if (sym_.complex) return RefactorizeT<cplx>((const cplx *)ax, (cplx *)lu, (cplx *)work, pool, threads, dirty, false);
+    return RefactorizeT<double>(ax, lu, work, pool, threads, dirty, false);
+}
+
+int HostLU::Refactorize(const double ax[], float lu[], double work[], ThreadPool &pool, int threads, const char dirty[]) const
+{
+    if (sym_.complex) return RefactorizeT<cplx>((const cplx *)ax, (cplxf *)lu, (cplx *)work, pool, threads, dirty, false);
+    return RefactorizeT<double>(ax, lu, work, pool, threads, dirty, false);
+}
+
+int HostLU::RefactorizeOrdered(const double fx[], double lu[], double work[], ThreadPool &pool, int threads) const
+{
+    if (sym_.complex) return RefactorizeT<cplx>((const cplx *)fx, (cplx *)lu, (cplx *)work, pool, threads, NULL, true);
+    return RefactorizeT<double>(fx, lu, work, pool, threads, NULL, true);
+}
+
+int HostLU::RefactorizeOrdered(const double fx[], float lu[], double work[], ThreadPool &pool, int threads) const
+{
+    if (sym_.complex) return RefactorizeT<cplx>((const cplx *)fx, (cplxf *)lu, (cplx *)work, pool, threads, NULL, true);
+    return RefactorizeT<double>(fx, lu, work, pool, threads, NULL, true);
+}
+
+idx_t HostLU::ColumnOf(idx_t p) const
+{
+    const idx_t c = (idx_t)(std::upper_bound(sym_.ap.begin(), sym_.ap.end(), p) - sym_.ap.begin()) - 1;
+    return sym_.qinv[c];
+}
+
+/*a column is recomputed when one of its own nonzeros changed or a column of its U part is recomputed*/
+idx_t HostLU::Propagate(char dirty[]) const
+{
+    const idx_t n = sym_.n;
+    const idx_t *cp = &sym_.cp[0];
+    const idx_t *ci = &sym_.ci[0];
+    const idx_t *dpos = &sym_.dpos[0];
+    idx_t k = 0;
+    while (k < n && !dirty[k]) ++k;
+    idx_t count = 0;
+    for (; k < n; ++k)
+    {
+        if (!dirty[k])
+        {
+            for (idx_t p = cp[k]; p < dpos[k]; ++p)
+            {
+                if (dirty[ci[p]])
+                {
+                    dirty[k] = 1;
+                    break;
+                }
+            }
+        }
+        if (dirty[k]) ++count;
+    }
+    return count;
+}
+
+/*partial pivoting with tolerance tol picks |pivot| >= tol * |candidate|, so the L entries are bounded by 1/tol, NaN fails the check*/
+template <typename T>
+idx_t HostLU::FirstBadPivotT(const T lu[], double tol) const
+{
+    const idx_t n = sym_.n;
+    const idx_t *cp = &sym_.cp[0];
+    const idx_t *dpos = &sym_.dpos[0];
+    const double limit = 1. / tol;
+    for (idx_t k = 0; k < n; ++k)
+    {
+        if (!(Magnitude(lu[dpos[k]]) > 0.)) return k;
+        for (idx_t p = dpos[k] + 1; p < cp[k + 1]; ++p)
+        {
+            if (!(Magnitude(lu[p]) <= limit)) return k;
+        }
+    }
+    return n;
+}
+
+idx_t HostLU::FirstBadPivot(const double lu[], double tol) const
+{
+    return sym_.complex ? FirstBadPivotT((const cplx *)lu, tol) : FirstBadPivotT(lu, tol);
+}
+
+/*
+* substitutions are split into scatter, one column of the first sweep, and the second sweep with gather,
+* so that the first sweep can follow refactorization column by column
+* row mode, B^T * x = b: U^T * L^T * (P * x) = Q^T * b, first sweep is U^T
+* column mode, B * x = b: L * U * (Q^T * x) = P * b, first sweep is L
+*/
+template <typename T>
+void HostLU::Scatter(const T b[], T y[], bool row0_column1) const
+{
+    const idx_t n = sym_.n;
+    if (row0_column1)
+    {
+        const idx_t *pinv = &sym_.pinv[0];
+        for (idx_t i = 0; i < n; ++i) y[pinv[i]] = b[i];
+    }
+    else
+    {
+        const idx_t *q = &sym_.q[0];
+        for (idx_t k = 0; k < n; ++k) y[k] = b[q[k]];
+    }
+}
+
+template <typename T, typename F>
+inline void HostLU::Forward(idx_t k, const F lu[], T y[], bool row0_column1) const
+{
+    const idx_t *cp = &sym_.cp[0];
+    const idx_t *ci = &sym_.ci[0];
+    const idx_t d = sym_.dpos[k];
+    if (row0_column1)
+    {
+        const T yk = y[k];
+        if (yk == T(0.)) return;
+        const idx_t end = cp[k + 1];
+        for (idx_t p = d + 1; p < end; ++p) y[ci[p]] -= T(lu[p]) * yk;
+    }
+    else
+    {
+        T s = y[k];
+        for (idx_t p = cp[k]; p < d; ++p) s -= T(lu[p]) * y[ci[p]];
+        y[k] = s / T(lu[d]);
+    }
+}
+
+/*second sweep in place, the solution is y in factor order*/
+template <typename T, typename F>
+void HostLU::BackwardSweep(const F lu[], T y[], bool row0_column1) const
+{
+    const idx_t n = sym_.n;
+    const idx_t *cp = &sym_.cp[0];
+    const idx_t *ci = &sym_.ci[0];
+    const idx_t *dpos = &sym_.dpos[0];
+
+    if (row0_column1)
+    {
+        for (idx_t k = n - 1; k >= 0; --k)
+        {
+            const T yk = y[k] / T(lu[dpos[k]]);
+            y[k] = yk;
+            if (yk == T(0.)) continue;
+            for (idx_t p = cp[k]; p < dpos[k]; ++p) y[ci[p]] -= T(lu[p]) * yk;
+        }
+    }
+    else
+    {
+        for (idx_t k = n - 1; k >= 0; --k)
+        {
+            T s = y[k];
+            const idx_t end = cp[k + 1];
+            for (idx_t p = dpos[k] + 1; p < end; ++p) s -= T(lu[p]) * y[ci[p]];
+            y[k] = s;
+        }
+    }
+}
+
+template <typename T, typename F>
+void HostLU::BackwardT(const F lu[], T y[], T x[], bool row0_column1) const
+{
+    const idx_t n = sym_.n;
+    BackwardSweep(lu, y, row0_column1);
+    if (row0_column1)
+    {
+        const idx_t *q = &sym_.q[0];
+        for (idx_t k = 0; k < n; ++k) x[q[k]] = y[k];
+    }
+    else
+    {
+        const idx_t *pinv = &sym_.pinv[0];
+        for (idx_t i = 0; i < n; ++i) x[i] = y[pinv[i]];
+    }
+}
+
+template <typename T, typename F>
+void HostLU::SolveT(const F lu[], const T b[], T x[], T y[], bool row0_column1) const
+{
+    {
+        TraceSpan span(trace_, "scatter");
+        Scatter(b, y, row0_column1);
+    }
+    {
+        TraceSpan span(trace_, "forward sweep");
+        for (idx_t k = 0; k < sym_.n; ++k) Forward(k, lu, y, row0_column1);
+    }
+    TraceSpan span(trace_, "backward sweep");
+    BackwardT(lu, y, x, row0_column1);
+}
+
+template <typename T, typename F>
+void HostLU::SolveOrderedT(const F lu[], T y[], bool row0_column1) const
+{
+    {
+        TraceSpan span(trace_, "forward sweep");
+        for (idx_t k = 0; k < sym_.n; ++k) Forward(k, lu, y, row0_column1);
+    }
+    TraceSpan span(trace_, "backward sweep");
+    BackwardSweep(lu, y, row0_column1);
+}
+
+void HostLU::SolveOrdered(const double lu[], double y[], bool row0_column1) const
+{
+    if (sym_.complex) SolveOrderedT<cplx>((const cplx *)lu, (cplx *)y, row0_column1);
+    else SolveOrderedT<double>(lu, y, row0_column1);
+}
+
+void HostLU::SolveOrdered(const float lu[], double y[], bool row0_column1) const
+{
+    if (sym_.complex) SolveOrderedT<cplx>((const cplxf *)lu, (cplx *)y, row0_column1);
+    else SolveOrderedT<double>(lu, y, row0_column1);
+}
+
+template <typename T>
+int HostLU::RefactorizeForwardT(const T ax[], T lu[], T work[], const T b[], T y[], bool row0_column1, ThreadPool &pool, int threads) const
+{
+    const idx_t n = sym_.n;
+    if (threads > pool.Threads()) threads = pool.Threads();
+    Scatter(b, y, row0_column1);
+    if (threads <= 1 || sym_.Levels() == n)
+    {
+        TraceSpan span(trace_, "fused refactor and forward sweep");
+        bool ok = true;
+        for (idx_t k = 0; k < n; ++k)
+        {
+            ok &= Column(k, ax, lu, work);
+            Forward(k, lu, y, row0_column1);
+        }
+        return ok ? 0 : -6;
+    }
+
+    const int ret = RefactorizeT(ax, lu, work, pool, threads, (const char *)NULL, false);
+    TraceSpan span(trace_, "forward sweep");
+    for (idx_t k = 0; k < n; ++k) Forward(k, lu, y, row0_column1);
+    return ret;
+}
+
+int HostLU::RefactorizeForward(const double ax[], double lu[], double work[], const double b[], double y[], bool row0_column1, ThreadPool &pool, int threads) const
+{
+    if (sym_.complex) return RefactorizeForwardT<cplx>((const cplx *)ax, (cplx *)lu, (cplx *)work, (const cplx *)b, (cplx *)y, row0_column1, pool, threads);
+    return RefactorizeForwardT<double>(ax, lu, work, b, y, row0_column1, pool, threads);
+}
+
+void HostLU::Backward(const double lu[], double y[], double x[], bool row0_column1) const
+{
+    TraceSpan span(trace_, "backward sweep");
+    if (sym_.complex) BackwardT<cplx>((const cplx *)lu, (cplx *)y, (cplx *)x, row0_column1);
+    else BackwardT<double>(lu, y, x, row0_column1);
+}
+
+void HostLU::Solve(const double lu[], const double b[], double x[], double work[], bool row0_column1) const
+{
+    if (sym_.complex) SolveT<cplx>((const cplx *)lu, (const cplx *)b, (cplx *)x, (cplx *)work, row0_column1);
+    else SolveT<double>(lu, b, x, work, row0_column1);
+}
+
+void HostLU::Solve(const float lu[], const double b[], double x[], double work[], bool row0_column1) const
+{
+    if (sym_.complex) SolveT<cplx>((const cplxf *)lu, (const cplx *)b, (cplx *)x, (cplx *)work, row0_column1);
+    else SolveT<double>(lu, b, x, work, row0_column1);
+}
+
+/*r = b - M * x in row mode, b - M^T * x in column mode, returns the 2-norm of r*/
+template <typename T>
+double HostLU::ResidualT(const T ax[], const T x[], const T b[], T r[], bool row0_column1) const
+{
+    const idx_t n = sym_.n;
+    const idx_t *ap = &sym_.ap[0];
+    const idx_t *ai = sym_.ai.empty() ? NULL : &sym_.ai[0];
+    if (row0_column1)
+    {
+        for (idx_t i = 0; i < n; ++i) r[i] = b[i];
+        for (idx_t i = 0; i < n; ++i)
+        {
+            const T xi = x[i];
+            for (idx_t p = ap[i]; p < ap[i + 1]; ++p) r[ai[p]] -= ax[p] * xi;
+        }
+    }
+    else
+    {
+        for (idx_t i = 0; i < n; ++i)
+        {
+            T s = b[i];
+            for (idx_t p = ap[i]; p < ap[i + 1]; ++p) s -= ax[p] * x[ai[p]];
+            r[i] = s;
+        }
+    }
+    double s = 0.;
+    for (idx_t i = 0; i < n; ++i) s += std::norm(r[i]);
+    return sqrt(s);
+}
+
+template <typename T, typename F>
+int HostLU::RefineT(const T ax[], const F lu[], const T b[], T x[], T work[], bool row0_column1, int steps, double target, double &res) const
+{
+    const idx_t n = sym_.n;
+    T *r = work;
+    T *y = work + n;
+    double bnorm = 0.;
+    for (idx_t i = 0; i < n; ++i) bnorm += std::norm(b[i]);
+    bnorm = sqrt(bnorm);
+    if (0. == bnorm) bnorm = 1.;
+
+    int step = 0;
+    for (;;)
+    {
+        res = ResidualT(ax, x, b, r, row0_column1) / bnorm;
+        if (res <= target || step >= steps) break;
+        SolveT(lu, r, r, y, row0_column1);
+        for (idx_t i = 0; i < n; ++i) x[i] += r[i];
+        ++step;
+    }
+    return step;
+}
+
+int HostLU::Refine(const double ax[], const double lu[], const double b[], double x[], double work[], bool row0_column1, int steps, double target, double &res) const
+{
+    if (sym_.complex) return RefineT<cplx>((const cplx *)ax, (const cplx *)lu, (const cplx *)b, (cplx *)x, (cplx *)work, row0_column1, steps, target, res);
+    return RefineT<double>(ax, lu, b, x, work, row0_column1, steps, target, res);
+}
+
+int HostLU::Refine(const double ax[], const float lu[], const double b[], double x[], double work[], bool row0_column1, int steps, double target, double &res) const
+{
+    if (sym_.complex) return RefineT<cplx>((const cplx *)ax, (const cplxf *)lu, (const cplx *)b, (cplx *)x, (cplx *)work, row0_column1, steps, target, res);
+    return RefineT<double>(ax, lu, b, x, work, row0_column1, steps, target, res);
+}
+
+/*
+* the m vectors of one block are interleaved by factor row, y[k * m + r], so every factor entry is loaded once for all of them
+*/
+template <typename T, typename F>
+void HostLU::SolveBlock(const F lu[], idx_t m, const T b[], idx_t ldb, T x[], idx_t ldx, T y[], bool row0_column1) const
+{
+    const idx_t n = sym_.n;
+    const idx_t *cp = &sym_.cp[0];
+    const idx_t *ci = &sym_.ci[0];
+    const idx_t *dpos = &sym_.dpos[0];
+    const idx_t *q = &sym_.q[0];
+    const idx_t *pinv = &sym_.pinv[0];
+
+    if (row0_column1)
+    {
+        for (idx_t r = 0; r < m; ++r)
+        {
+            const T *br = b + r * ldb;
+            for (idx_t i = 0; i < n; ++i) y[pinv[i] * m + r] = br[i];
+        }
+        for (idx_t k = 0; k < n; ++k)
+        {
+            const T *yk = y + k * m;
+            const idx_t end = cp[k + 1];
+            for (idx_t p = dpos[k] + 1; p < end; ++p)
+            {
+                const T l = T(lu[p]);
+                T *yi = y + ci[p] * m;
+                for (idx_t r = 0; r < m; ++r) yi[r] -= l * yk[r];
+            }
+        }
+        for (idx_t k = n - 1; k >= 0; --k)
+        {
+            T *yk = y + k * m;
+            const T d = T(lu[dpos[k]]);
+            for (idx_t r = 0; r < m; ++r) yk[r] /= d;
+            for (idx_t p = cp[k]; p < dpos[k]; ++p)
+            {
+                const T u = T(lu[p]);
+                T *yi = y + ci[p] * m;
+                for (idx_t r = 0; r < m; ++r) yi[r] -= u * yk[r];
+            }
+        }
+        for (idx_t r = 0; r < m; ++r)
+        {
+            T *xr = x + r * ldx;
+            for (idx_t k = 0; k < n; ++k) xr[q[k]] = y[k * m + r];
+        }
+    }
+    else
+    {
+        for (idx_t r = 0; r < m; ++r)
+        {
+            const T *br = b + r * ldb;
+            for (idx_t k = 0; k < n; ++k) y[k * m + r] = br[q[k]];
+        }
+        for (idx_t k = 0; k < n; ++k)
+        {
+            T *yk = y + k * m;
+            for (idx_t p = cp[k]; p < dpos[k]; ++p)
+            {
+                const T u = T(lu[p]);
+                const T *yi = y + ci[p] * m;
+                for (idx_t r = 0; r < m; ++r) yk[r] -= u * yi[r];
+            }
+            const T d = T(lu[dpos[k]]);
+            for (idx_t r = 0; r < m; ++r) yk[r] /= d;
+        }
+        for (idx_t k = n - 1; k >= 0; --k)
+        {
+            T *yk = y + k * m;
+            const idx_t end = cp[k + 1];
+            for (idx_t p = dpos[k] + 1; p < end; ++p)
+            {
+                const T l = T(lu[p]);
+                const T *yi = y + ci[p] * m;
+                for (idx_t r = 0; r < m; ++r) yk[r] -= l * yi[r];
+            }
+        }
+        for (idx_t r = 0; r < m; ++r)
+        {
+            T *xr = x + r * ldx;
+            for (idx_t i = 0; i < n; ++i) xr[i] = y[pinv[i] * m + r];
+        }
+    }
+}
+
+template <typename T, typename F>
+void HostLU::SolveManyT(const F lu[], idx_t nrhs, const T b[], idx_t ldb, T x[], idx_t ldx, T work[], bool row0_column1, ThreadPool &pool, int threads) const
+{
+    const idx_t n = sym_.n;
+    const idx_t blocks = (nrhs + SOLVE_CHUNK - 1) / SOLVE_CHUNK;
+    if (threads > pool.Threads()) threads = pool.Threads();
+    if (threads > blocks) threads = (int)blocks;
+    std::atomic<idx_t> next(0);
+
+    pool.Run(threads, [&](int tid)
+    {
+        T *y = work + (size_t)tid * n * SOLVE_CHUNK;
+        for (;;)
+        {
+            const idx_t blk = next.fetch_add(1, std::memory_order_relaxed);
+            if (blk >= blocks) break;
+            const idx_t r0 = blk * SOLVE_CHUNK;
+            const idx_t m = nrhs - r0 < SOLVE_CHUNK ? nrhs - r0 : SOLVE_CHUNK;
+            TraceSpan span(trace_, "solve chunk", tid, "first vector", r0);
+            SolveBlock(lu, m, b + r0 * ldb, ldb, x + r0 * ldx, ldx, y, row0_column1);
+        }
+    });
+}
+
+void HostLU::SolveMany(const double lu[], idx_t nrhs, const double b[], idx_t ldb, double x[], idx_t ldx, double work[], bool row0_column1, ThreadPool &pool, int threads) const
+{
+    if (sym_.complex) SolveManyT<cplx>((const cplx *)lu, nrhs, (const cplx *)b, ldb, (cplx *)x, ldx, (cplx *)work, row0_column1, pool, threads);
+    else SolveManyT<double>(lu, nrhs, b, ldb, x, ldx, work, row0_column1, pool, threads);
+}
+
+void HostLU::SolveMany(const float lu[], idx_t nrhs, const double b[], idx_t ldb, double x[], idx_t ldx, double work[], bool row0_column1, ThreadPool &pool, int threads) const
+{
+    if (sym_.complex) SolveManyT<cplx>((const cplxf *)lu, nrhs, (const cplx *)b, ldb, (cplx *)x, ldx, (cplx *)work, row0_column1, pool, threads);
+    else SolveManyT<double>(lu, nrhs, b, ldb, x, ldx, work, row0_column1, pool, threads);
+}
+
+void HostLU::Rows(FactorRows &rows)
+{
+    const idx_t n = sym_.n;
+    const idx_t *cp = &sym_.cp[0];
+    const idx_t *ci = &sym_.ci[0];
+    const idx_t *dpos = &sym_.dpos[0];
+    Resize(rows.rp, (size_t)n + 1);
+    Resize(rows.rdiag, (size_t)n);
+    Resize(rows.ri, (size_t)(cp[n] - n));
+    std::vector<idx_t> &rp = rows.rp;
+    std::fill(rp.begin(), rp.end(), 0);
+    for (idx_t k = 0; k < n; ++k)
+    {
+        for (idx_t p = cp[k]; p < cp[k + 1]; ++p)
+        {
+            if (p != dpos[k]) ++rp[ci[p] + 1];
+        }
+    }
+    for (idx_t i = 0; i < n; ++i) rp[i + 1] += rp[i];
+
+    /*L entries first, then U entries, each in ascending column order*/
+    std::vector<idx_t> next(rp.begin(), rp.end() - 1);
+    for (idx_t k = 0; k < n; ++k)
+    {
+        for (idx_t p = dpos[k] + 1; p < cp[k + 1]; ++p) rows.ri[next[ci[p]]++] = k;
+    }
+    std::copy(next.begin(), next.end(), rows.rdiag.begin());
+    for (idx_t k = 0; k < n; ++k)
+    {
+        for (idx_t p = cp[k]; p < dpos[k]; ++p) rows.ri[next[ci[p]]++] = k;
+    }
+}
+
+/*
+* the sweeps, with the edges of column k: push(k) are the columns k updates, pull(k) those k reads
+* row mode: forward U^T, push = U row, pull = U column | backward L^T, push = L row, pull = L column
+* column mode: forward L, push = L column, pull = L row | backward U, push = U column, pull = U row
+* without requested outputs, each sweep computes the push reach of its nonzeros. With requested outputs, the backward sweep
+* is limited to the pull closure of the outputs, the forward sweep to the pull closure of that, and a column of these closures
+* is computed when its input or one of the columns it reads is nonzero
+*/
+#define SP_B        1   /*nonzero of b*/
+#define SP_FSET     2   /*in the forward closure or reach*/
+#define SP_BSET     4   /*in the backward closure or reach*/
+#define SP_FNZ      8   /*nonzero after the forward sweep*/
+#define SP_BNZ      16  /*nonzero after the backward sweep*/
+#define SP_TOUCHED  32
+
+enum { L_COLUMN, U_COLUMN, L_ROW, U_ROW };
+
+void HostLU::PlanSparse(const FactorRows &rows, SparsePlan &plan, std::vector<char> &mark) const
+{
+    const idx_t *cp = &sym_.cp[0];
+    const idx_t *ci = &sym_.ci[0];
+    const idx_t *dpos = &sym_.dpos[0];
+    const idx_t *rp = &rows.rp[0];
+    const idx_t *ri = rows.ri.data();
+    const idx_t *rd = &rows.rdiag[0];
+    const bool col = plan.row0_column1;
+    const idx_t *bmap = col ? &sym_.pinv[0] : &sym_.qinv[0];
+    const idx_t *xmap = col ? &sym_.qinv[0] : &sym_.pinv[0];
+    const int fpush = col ? L_COLUMN : U_ROW, fpull = col ? L_ROW : U_COLUMN;
+    const int bpush = col ? U_COLUMN : L_ROW, bpull = col ? U_ROW : L_COLUMN;
+
+    auto edges = [&](int kind, idx_t k, const idx_t *&first, const idx_t *&last)
+    {
+        switch (kind)
+        {
+        case L_COLUMN: first = ci + dpos[k] + 1; last = ci + cp[k + 1]; break;
+        case U_COLUMN: first = ci + cp[k]; last = ci + dpos[k]; break;
+        case L_ROW: first = ri + rp[k]; last = ri + rd[k]; break;
+        default: first = ri + rd[k]; last = ri + rp[k + 1]; break;
+        }
+    };
+    /*extends set, whose members are flagged with bit, by the columns reachable along edges of kind*/
+    auto reach = [&](int kind, char bit, std::vector<idx_t> &set)
+    {
+        for (size_t s = 0; s < set.size(); ++s)
+        {
+            const idx_t *first, *last;
+            edges(kind, set[s], first, last);
+            for (; first < last; ++first)
+            {
+                if (mark[*first] & bit) continue;
+                mark[*first] |= bit;
+                set.push_back(*first);
+            }
+        }
+    };
+    auto add = [&](std::vector<idx_t> &set, idx_t k, char bit)
+    {
+        if (mark[k] & bit) return;
+        mark[k] |= bit;
+        set.push_back(k);
+    };
+
+    std::vector<idx_t> bset, fset, bwset, touched;
+    for (size_t i = 0; i < plan.b.size(); ++i) add(bset, bmap[plan.b[i]], SP_B);
+    plan.forward.clear();
+    plan.backward.clear();
+    if (plan.out.empty())
+    {
+        for (size_t i = 0; i < bset.size(); ++i) add(fset, bset[i], SP_FSET);
+        reach(fpush, SP_FSET, fset);
+        std::sort(fset.begin(), fset.end());
+        for (size_t i = 0; i < fset.size(); ++i) add(bwset, fset[i], SP_BSET);
+        reach(bpush, SP_BSET, bwset);
+        std::sort(bwset.begin(), bwset.end(), std::greater<idx_t>());
+        plan.forward = fset;
+        plan.backward = bwset;
+    }
+    else
+    {
+        for (size_t i = 0; i < plan.out.size(); ++i) add(bwset, xmap[plan.out[i]], SP_BSET);
+        reach(bpull, SP_BSET, bwset);
+        for (size_t i = 0; i < bwset.size(); ++i) add(fset, bwset[i], SP_FSET);
+        reach(fpull, SP_FSET, fset);
+        std::sort(fset.begin(), fset.end());
+        std::sort(bwset.begin(), bwset.end(), std::greater<idx_t>());
+
+        /*columns read are computed before the columns reading them, so their flags are final*/
+        for (size_t i = 0; i < fset.size(); ++i)
+        {
+            const idx_t k = fset[i];
+            bool nz = (mark[k] & SP_B) != 0;
+            const idx_t *first, *last;
+            edges(fpull, k, first, last);
+            for (; !nz && first < last; ++first) nz = (mark[*first] & SP_FNZ) != 0;
+            if (!nz) continue;
+            mark[k] |= SP_FNZ;
+            plan.forward.push_back(k);
+        }
+        for (size_t i = 0; i < bwset.size(); ++i)
+        {
+            const idx_t k = bwset[i];
+            bool nz = (mark[k] & SP_FNZ) != 0;
+            const idx_t *first, *last;
+            edges(bpull, k, first, last);
+            for (; !nz && first < last; ++first) nz = (mark[*first] & SP_BNZ) != 0;
+            if (!nz) continue;
+            mark[k] |= SP_BNZ;
+            plan.backward.push_back(k);
+        }
+    }
+
+    /*the scattered b, the computed columns, and in column mode the columns they update*/
+    for (size_t i = 0; i < bset.size(); ++i) add(touched, bset[i], SP_TOUCHED);
+    for (size_t i = 0; i < plan.forward.size(); ++i)
+    {
+        const idx_t k = plan.forward[i];
+        add(touched, k, SP_TOUCHED);
+        if (!col) continue;
+        const idx_t *first, *last;
+        edges(fpush, k, first, last);
+        for (; first < last; ++first) add(touched, *first, SP_TOUCHED);
+    }
+    for (size_t i = 0; i < plan.backward.size(); ++i)
+    {
+        const idx_t k = plan.backward[i];
+        add(touched, k, SP_TOUCHED);
+        if (!col) continue;
+        const idx_t *first, *last;
+        edges(bpush, k, first, last);
+        for (; first < last; ++first) add(touched, *first, SP_TOUCHED);
+    }
+    plan.touched.swap(touched);
+
+    /*every flagged column is in one of the sets*/
+    for (size_t i = 0; i < bset.size(); ++i) mark[bset[i]] = 0;
+    for (size_t i = 0; i < fset.size(); ++i) mark[fset[i]] = 0;
+    for (size_t i = 0; i < bwset.size(); ++i) mark[bwset[i]] = 0;
+    for (size_t i = 0; i < plan.touched.size(); ++i) mark[plan.touched[i]] = 0;
+}
+
+template <typename T, typename F>
+void HostLU::SolveSparseT(const F lu[], const SparsePlan &plan, const T val[], T x[], T y[]) const
+{
+    const idx_t n = sym_.n;
+    const idx_t *cp = &sym_.cp[0];
+    const idx_t *ci = &sym_.ci[0];
+    const idx_t *dpos = &sym_.dpos[0];
+    const bool col = plan.row0_column1;
+    const idx_t *bmap = col ? &sym_.pinv[0] : &sym_.qinv[0];
+    const idx_t *xmap = col ? &sym_.qinv[0] : &sym_.pinv[0];
+
+    for (size_t i = 0; i < plan.b.size(); ++i) y[bmap[plan.b[i]]] += val[i];
+    {
+        TraceSpan span(trace_, "forward sweep", 0, "columns", (long long)plan.forward.size());
+        for (size_t i = 0; i < plan.forward.size(); ++i) Forward(plan.forward[i], lu, y, col);
+    }
+    {
+        TraceSpan span(trace_, "backward sweep", 0, "columns", (long long)plan.backward.size());
+        for (size_t i = 0; i < plan.backward.size(); ++i)
+        {
+            const idx_t k = plan.backward[i];
+            if (col)
+            {
+                const T yk = y[k] / T(lu[dpos[k]]);
+                y[k] = yk;
+                for (idx_t p = cp[k]; p < dpos[k]; ++p) y[ci[p]] -= T(lu[p]) * yk;
+            }
+            else
+            {
+                T s = y[k];
+                const idx_t end = cp[k + 1];
+                for (idx_t p = dpos[k] + 1; p < end; ++p) s -= T(lu[p]) * y[ci[p]];
+                y[k] = s;
+            }
+        }
+    }
+
+    if (plan.out.empty())
+    {
+        for (idx_t i = 0; i < n; ++i) x[i] = y[xmap[i]];
+    }
+    else
+    {
+        for (size_t r = 0; r < plan.out.size(); ++r) x[r] = y[xmap[plan.out[r]]];
+    }
+    for (size_t i = 0; i < plan.touched.size(); ++i) y[plan.touched[i]] = T(0.);
+}
+
+void HostLU::SolveSparse(const double lu[], const SparsePlan &plan, const double val[], double x[], double y[]) const
+{
+    if (sym_.complex) SolveSparseT<cplx>((const cplx *)lu, plan, (const cplx *)val, (cplx *)x, (cplx *)y);
+    else SolveSparseT<double>(lu, plan, val, x, y);
+}
+
+void HostLU::SolveSparse(const float lu[], const SparsePlan &plan, const double val[], double x[], double y[]) const
+{
+    if (sym_.complex) SolveSparseT<cplx>((const cplxf *)lu, plan, (const cplx *)val, (cplx *)x, (cplx *)y);
+    else SolveSparseT<double>(lu, plan, val, x, y);
+}
+
+/*same as SolveT for complex values, with the scatter and gather reading and writing split parts*/
+template <typename T, typename F>
+void HostLU::SolveSplitT(const F lu[], const double bre[], const double bim[], double xre[], double xim[], T y[], bool row0_column1) const
+{
+    const idx_t n = sym_.n;
+    const idx_t *q = &sym_.q[0];
+    const idx_t *pinv = &sym_.pinv[0];
+    {
+        TraceSpan span(trace_, "scatter");
+        if (row0_column1)
+        {
+            for (idx_t i = 0; i < n; ++i) y[pinv[i]] = T(bre[i], bim[i]);
+        }
+        else
+        {
+            for (idx_t k = 0; k < n; ++k) y[k] = T(bre[q[k]], bim[q[k]]);
+        }
+    }
+    {
+        TraceSpan span(trace_, "forward sweep");
+        for (idx_t k = 0; k < n; ++k) Forward(k, lu, y, row0_column1);
+    }
+    TraceSpan span(trace_, "backward sweep");
+    BackwardSweep(lu, y, row0_column1);
+    if (row0_column1)
+    {
+        for (idx_t k = 0; k < n; ++k)
+        {
+            xre[q[k]] = y[k].real();
+            xim[q[k]] = y[k].imag();
+        }
+    }
+    else
+    {
+        for (idx_t i = 0; i < n; ++i)
+        {
+            xre[i] = y[pinv[i]].real();
+            xim[i] = y[pinv[i]].imag();
+        }
+    }
+}
+
+void HostLU::SolveSplit(const double lu[], const double bre[], const double bim[], double xre[], double xim[], double work[], bool row0_column1) const
+{
+    SolveSplitT<cplx>((const cplx *)lu, bre, bim, xre, xim, (cplx *)work, row0_column1);
+}
+
+void HostLU::SolveSplit(const float lu[], const double bre[], const double bim[], double xre[], double xim[], double work[], bool row0_column1) const
+{
+    SolveSplitT<cplx>((const cplxf *)lu, bre, bim, xre, xim, (cplx *)work, row0_column1);
+}
+
+}
@@ -0,0 +1,297 @@
+/*sparse LU engine of the host accelerator*/
+#ifndef __CKTSO_HOST_LU__
+#define __CKTSO_HOST_LU__
+
+#include <string>
+#include <vector>
+#include "host_pool.h"
+#include "host_trace.h"
+
+namespace cktso_host
+{
+
+typedef long long idx_t;
+
+#define SOLVE_CHUNK 16
+
+/*column orderings of Factorize*/
+#define ORDER_AMD   0 /*approximate minimum degree, fill-reducing*/
+#define ORDER_RCM   1 /*reverse Cuthill-McKee, narrow band*/
+
+static inline unsigned long long HashMix(unsigned long long h, unsigned long long v)
+{
+    h ^= v;
+    h *= 0x100000001b3ULL;
+    return h ^ (h >> 29);
+}
+
+template <typename Index>
+inline unsigned long long HashArray(unsigned long long h, const Index a[], size_t len)
+{
+    for (size_t i = 0; i < len; ++i) h = HashMix(h, (unsigned long long)a[i]);
+    return HashMix(h, (unsigned long long)len);
+}
+
+/*PatternHash: hash of a matrix pattern, the key of saved structures and tuning records, the same for int and long long indexes*/
+template <typename Index>
+inline unsigned long long PatternHash(Index n, const Index ap[], const Index ai[])
+{
+    unsigned long long h = HashMix(0xcbf29ce484222325ULL, (unsigned long long)n);
+    h = HashArray(h, ap, (size_t)n + 1);
+    return HashArray(h, ai, (size_t)ap[n]);
+}
+
+/*TempName: private file to write before renaming it over file, unique among the threads and calls of all processes*/
+std::string TempName(const char file[]);
+
+/*
+* Symbolic: matrix pattern, pivot sequence and LU factors structure
+* The user matrix M is given row-wise (ap, ai), as CKTSO does. LU factorizes B = M^T column by column, so that
+* P * B * Q = L * U, where the k-th factor column is B column (= M row) q[k] and pinv[i] is the factor index of B row i.
+* Factor column k is stored in [cp[k], cp[k+1]) with ascending factor rows: U part, diagonal (at dpos[k]), L part (unit L).
+*/
+struct Symbolic
+{
+    idx_t n;
+    idx_t nnz;
+    bool complex;
+    std::vector<idx_t> ap, ai;
+    std::vector<idx_t> q, qinv, pinv;
+    std::vector<idx_t> cp, ci, dpos;
+    std::vector<idx_t> amap; /*position of each nonzero of M in factor storage*/
+    std::vector<idx_t> level, lvptr, lvcol; /*level schedule of columns*/
+    idx_t nbulk; /*#leading levels refactorized in bulk mode*/
+
+    Symbolic() : n(0), nnz(0), complex(false), nbulk(0) {}
+
+    idx_t FactorNnz() const
+    {
+        return cp.empty() ? 0 : cp[n];
+    }
+    idx_t Levels() const
+    {
+        return lvptr.empty() ? 0 : (idx_t)lvptr.size() - 1;
+    }
+    size_t Bytes() const;
+    /*floating-point operations of refactorizing factor column k (an update by each U entry, the L scaling), complex ones counting as 4*/
+    long long ColumnFlops(idx_t k) const;
+    long long Flops() const;
+};
+
+/*
+* FactorRows: row patterns of the factors, for the sparse solves, which walk the factor graph in both directions
+* Row k holds its L columns in ri[rp[k], rdiag[k]) and its U columns in ri[rdiag[k], rp[k+1]), the diagonal excluded
+*/
+struct FactorRows
+{
+    std::vector<idx_t> rp, ri, rdiag;
+};
+
+/*
+* SparsePlan: factor columns computed by each substitution sweep of a sparse solve, in sweep order
+* forward holds the reach of the nonzeros of b, backward the reach of forward, both pruned to the columns the requested outputs depend on
+*/
+struct SparsePlan
+{
+    unsigned long long hash;
+    bool row0_column1;
+    std::vector<idx_t> b, out; /*matrix indexes of the nonzeros of b and of the requested outputs (empty for all)*/
+    std::vector<idx_t> forward, backward;
+    std::vector<idx_t> touched; /*work space positions written by the solve*/
+};
+
+class HostLU
+{
+public:
+    HostLU() : required_(0), trace_(NULL) {}
+
+    /*
+    * Factorize: orders, pivots and factorizes the matrix, building the symbolic structure
+    * @lu: factor values, resized to (complex ? 2 : 1) * cp[n]
+    * @tol: diagonal pivoting tolerance
+    * @ordering: ORDER_AMD or ORDER_RCM, on the pattern of B + B^T
+    * returns 0, -3 (invalid matrix) or -6 (numerically singular)
+    */
+    int Factorize(bool complex, idx_t n, const idx_t ap[], const idx_t ai[], const double ax[], double tol, int ordering, std::vector<double> &lu);
+
+    /*
+    * Schedule: rebuilds the bulk/pipeline partition
+    * @threshold: levels with at least threshold columns are refactorized in bulk mode, once a level is narrower, the rest is pipelined
+    */
+    void Schedule(int threshold);
+
+    /*
+    * Load: restores the symbolic structure saved by Save, when the file matches the given pattern and passes the integrity checks
+    * The level schedule is restored too, call Schedule for the bulk/pipeline partition
+    * returns false, leaving the current structure unchanged, when the file is missing, of another version or pattern, or corrupted
+    */
+    bool Load(const char file[], bool complex, idx_t n, const idx_t ap[], const idx_t ai[]);
+
+    /*Save: writes the symbolic structure, returns false when the file cannot be written*/
+    bool Save(const char file[]) const;
+
+    /*
+    * FirstBadPivot: first factor column that does not meet the pivoting tolerance, i.e., with a zero pivot or an L entry |l| > 1/tol, n if none
+    * Used when the pivot sequence was not chosen for the current values (e.g., loaded by Load)
+    */
+    idx_t FirstBadPivot(const double lu[], double tol) const;
+
+    /*
+    * Repivot: factorizes new values of the same pattern, keeping the ordering. The leading columns whose pivots still meet
+    * the tolerance keep their pivots, structure and levels, the others are pivoted and rebuilt as Factorize does
+    * @lu: factor values, resized to (complex ? 2 : 1) * cp[n]
+    * @work: as Refactorize
+    * @repivoted: #trailing columns pivoted again, 0 when the structure is unchanged
+    * returns 0 or -6 (numerically singular)
+    */
+    int Repivot(const double ax[], double tol, std::vector<double> &lu, double work[], ThreadPool &pool, int threads, idx_t &repivoted);
+
+    /*
+    * Refactorize: refactorizes without pivoting, using the pivot sequence found by Factorize
+    * @work: zero-initialized work space of (complex ? 2 : 1) * n doubles per thread, it is zero again on return
+    * @dirty: n flags of the columns to recompute, the others are kept, NULL for all columns
+    * returns 0 or -6 (zero pivot)
+    */
+    int Refactorize(const double ax[], double lu[], double work[], ThreadPool &pool, int threads, const char dirty[] = NULL) const;
+    int Refactorize(const double ax[], float lu[], double work[], ThreadPool &pool, int threads, const char dirty[] = NULL) const;
+
+    /*
+    * RefactorizeOrdered: same as Refactorize, with values in factor storage order
+    * @fx: FactorNnz() (complex: 2x) doubles, nonzero p of M at amap[p], zero at fill-ins
+    */
+    int RefactorizeOrdered(const double fx[], double lu[], double work[], ThreadPool &pool, int threads) const;
+    int RefactorizeOrdered(const double fx[], float lu[], double work[], ThreadPool &pool, int threads) const;
+
+    /*ColumnOf: factor column holding nonzero p of M*/
+    idx_t ColumnOf(idx_t p) const;
+
+    /*
+    * Propagate: adds to dirty every column that depends on a dirty column, returns #dirty columns
+    * @dirty: n flags, columns holding changed nonzeros are set by the caller
+    */
+    idx_t Propagate(char dirty[]) const;
+
+    /*
+    * RefactorizeSequential: refactorizes in the calling thread, used when a batch of value sets is spread over threads
+    * @work: zero-initialized work space of (complex ? 2 : 1) * n doubles
+    */
+    int RefactorizeSequential(const double ax[], double lu[], double work[]) const;
+    int RefactorizeSequential(const double ax[], float lu[], double work[]) const;
+
+    /*
+    * Solve: forward and backward substitutions
+    * @work: work space of (complex ? 2 : 1) * n doubles
+    * @row0_column1: row mode solves M * x = b, column mode solves M^T * x = b
+    */
+    void Solve(const double lu[], const double b[], double x[], double work[], bool row0_column1) const;
+    void Solve(const float lu[], const double b[], double x[], double work[], bool row0_column1) const;
+
+    /*
+    * SolveOrdered: both substitution sweeps in place, y is b and then x in factor order,
+    * b[q[k]] at y[k] in row mode and b[i] at y[pinv[i]] in column mode, and the reverse for x
+    */
+    void SolveOrdered(const double lu[], double y[], bool row0_column1) const;
+    void SolveOrdered(const float lu[], double y[], bool row0_column1) const;
+
+    /*
+    * SolveSplit: same as Solve for a complex matrix, with real and imaginary parts of b and x in separate arrays
+    * x may be b (xre = bre and xim = bim)
+    */
+    void SolveSplit(const double lu[], const double bre[], const double bim[], double xre[], double xim[], double work[], bool row0_column1) const;
+    void SolveSplit(const float lu[], const double bre[], const double bim[], double xre[], double xim[], double work[], bool row0_column1) const;
+
+    /*
+    * Refine: iterative refinement of x against the double values ax, corrections are solved with the factors
+    * @work: work space of (complex ? 2 : 1) * 2n doubles
+    * @steps: maximum #refinement steps
+    * @target: stops when ||b - A * x||2 / ||b||2 <= target
+    * @res: relative residual of the returned x
+    * returns #steps done
+    */
+    int Refine(const double ax[], const double lu[], const double b[], double x[], double work[], bool row0_column1, int steps, double target, double &res) const;
+    int Refine(const double ax[], const float lu[], const double b[], double x[], double work[], bool row0_column1, int steps, double target, double &res) const;
+
+    /*
+    * RefactorizeForward: refactorizes and runs the first substitution sweep of b into y, Backward finishes the solve into x
+    * In sequential mode, the first sweep follows each factor column while it is still in cache
+    * @y: work space of (complex ? 2 : 1) * n doubles, kept between the two calls
+    */
+    int RefactorizeForward(const double ax[], double lu[], double work[], const double b[], double y[], bool row0_column1, ThreadPool &pool, int threads) const;
+    void Backward(const double lu[], double y[], double x[], bool row0_column1) const;
+
+    /*
+    * SolveMany: solves nrhs vectors in one sweep of the factors per chunk of SOLVE_CHUNK vectors, chunks are spread over threads
+    * @ldb, ldx: leading dimensions, in real or complex numbers
+    * @work: work space of (complex ? 2 : 1) * n * SOLVE_CHUNK doubles per thread
+    */
+    void SolveMany(const double lu[], idx_t nrhs, const double b[], idx_t ldb, double x[], idx_t ldx, double work[], bool row0_column1, ThreadPool &pool, int threads) const;
+    void SolveMany(const float lu[], idx_t nrhs, const double b[], idx_t ldb, double x[], idx_t ldx, double work[], bool row0_column1, ThreadPool &pool, int threads) const;
+
+    /*Rows: builds the row patterns of the factors*/
+    void Rows(FactorRows &rows);
+
+    /*
+    * PlanSparse: fills the sweeps of plan from plan.b, plan.out and plan.row0_column1
+    * @mark: work space of n flags, zero on entry and on return
+    */
+    void PlanSparse(const FactorRows &rows, SparsePlan &plan, std::vector<char> &mark) const;
+
+    /*
+    * SolveSparse: substitutions limited to the sweeps of plan
+    * @val: values of the nonzeros of b, in plan.b order, duplicated indexes are summed
+    * @x: solution at plan.out, in its order, or all n entries when plan.out is empty
+    * @y: work space of (complex ? 2 : 1) * n doubles, zero on entry and on return
+    */
+    void SolveSparse(const double lu[], const SparsePlan &plan, const double val[], double x[], double y[]) const;
+    void SolveSparse(const float lu[], const SparsePlan &plan, const double val[], double x[], double y[]) const;
+
+    const Symbolic &Sym() const
+    {
+        return sym_;
+    }
+
+    /*SetTrace: tracer of the refactor levels and solve sweeps, NULL to stop tracing*/
+    void SetTrace(Tracer *trace)
+    {
+        trace_ = trace;
+    }
+
+    /*bytes of the last allocation attempt, valid when std::bad_alloc was thrown*/
+    long long Required() const
+    {
+        return required_;
+    }
+
+private:
+    template <typename T> int FactorizeT(const T ax[], double tol, std::vector<double> &lu, idx_t start);
+    /*T is the computing type, F is the factors storage type (T, or its single precision counterpart)*/
+    template <typename T, typename F> int RefactorizeT(const T ax[], F lu[], T work[], ThreadPool &pool, int threads, const char dirty[], bool ordered) const;
+    template <typename T, typename F> bool Column(idx_t k, const T ax[], F lu[], T w[], bool ordered = false) const;
+    template <typename T> void Scatter(const T b[], T y[], bool row0_column1) const;
+    template <typename T, typename F> void Forward(idx_t k, const F lu[], T y[], bool row0_column1) const;
+    template <typename T, typename F> void BackwardSweep(const F lu[], T y[], bool row0_column1) const;
+    template <typename T, typename F> void BackwardT(const F lu[], T y[], T x[], bool row0_column1) const;
+    template <typename T, typename F> void SolveT(const F lu[], const T b[], T x[], T y[], bool row0_column1) const;
+    template <typename T, typename F> void SolveOrderedT(const F lu[], T y[], bool row0_column1) const;
+    template <typename T, typename F> void SolveSplitT(const F lu[], const double bre[], const double bim[], double xre[], double xim[], T y[], bool row0_column1) const;
+    template <typename T> int RefactorizeForwardT(const T ax[], T lu[], T work[], const T b[], T y[], bool row0_column1, ThreadPool &pool, int threads) const;
+    template <typename T, typename F> void SolveBlock(const F lu[], idx_t m, const T b[], idx_t ldb, T x[], idx_t ldx, T y[], bool row0_column1) const;
+    template <typename T, typename F> void SolveManyT(const F lu[], idx_t nrhs, const T b[], idx_t ldb, T x[], idx_t ldx, T work[], bool row0_column1, ThreadPool &pool, int threads) const;
+    template <typename T, typename F> void SolveSparseT(const F lu[], const SparsePlan &plan, const T val[], T x[], T y[]) const;
+    template <typename T> idx_t FirstBadPivotT(const T lu[], double tol) const;
+    template <typename T> double ResidualT(const T ax[], const T x[], const T b[], T r[], bool row0_column1) const;
+    template <typename T, typename F> int RefineT(const T ax[], const F lu[], const T b[], T x[], T work[], bool row0_column1, int steps, double target, double &res) const;
+    template <typename V> void Resize(V &v, size_t size);
+    void Order(int ordering);
+    void Amd(std::vector<idx_t> &xadj, std::vector<idx_t> &adj);
+    void Rcm(const std::vector<idx_t> &xadj, const std::vector<idx_t> &adj);
+    void Levels(idx_t start);
+
+    Symbolic sym_;
+    long long required_;
+    Tracer *trace_;
+};
+
+}
+
+#endif
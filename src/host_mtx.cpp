@@ -0,0 +1,434 @@
+#include <algorithm>
+#include <atomic>
+#include <ctype.h>
+#include <limits.h>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "../cktso-gpu-host.h"
+#include "host_pool.h"
+
+namespace cktso_host
+{
+
+/*
+* MappedFile: read-only view of a whole file, memory-mapped where available, read into memory otherwise
+*/
+class MappedFile
+{
+public:
+    MappedFile() : data_(NULL), size_(0), mapped_(false) {}
+    ~MappedFile()
+    {
+#ifndef _WIN32
+        if (mapped_)
+        {
+            munmap((void *)data_, size_);
+            return;
+        }
+#endif
+        free((void *)data_);
+    }
+
+    bool Open(const char file[])
+    {
+#ifndef _WIN32
+        const int fd = open(file, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED)
+            {
+                madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+                data_ = (const char *)p;
+                size_ = (size_t)st.st_size;
+                mapped_ = true;
+                close(fd);
+                return true;
+            }
+        }
+        close(fd);
+#endif
+        FILE *fp = fopen(file, "rb");
+        if (NULL == fp) return false;
+        fseek(fp, 0, SEEK_END);
+        const long size = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        if (size <= 0)
+        {
+            fclose(fp);
+            return false;
+        }
+        char *p = (char *)malloc((size_t)size);
+        if (NULL == p || fread(p, 1, (size_t)size, fp) != (size_t)size)
+        {
+            free(p);
+            fclose(fp);
+            return false;
+        }
+        fclose(fp);
+        data_ = p;
+        size_ = (size_t)size;
+        return true;
+    }
+
+    const char *Data() const
+    {
+        return data_;
+    }
+    size_t Size() const
+    {
+        return size_;
+    }
+
+private:
+    const char *data_;
+    size_t size_;
+    bool mapped_;
+};
+
+enum MtxField { MTX_REAL, MTX_COMPLEX, MTX_PATTERN };
+enum MtxSymmetry { MTX_GENERAL, MTX_SYMMETRIC, MTX_SKEW, MTX_HERMITIAN };
+
+static inline bool Space(char c)
+{
+    return ' ' == c || '\t' == c || '\r' == c;
+}
+
+/*end of the line starting at p (position of '\n' or end)*/
+static inline const char *LineEnd(const char *p, const char *end)
+{
+    const char *q = (const char *)memchr(p, '\n', (size_t)(end - p));
+    return NULL == q ? end : q;
+}
+
+/*a data line is neither empty nor a comment*/
+static inline bool DataLine(const char *p, const char *eol)
+{
+    while (p < eol && Space(*p)) ++p;
+    return p < eol && *p != '%';
+}
+
+/*an index beyond LLONG_MAX is rejected rather than wrapped into range*/
+static inline bool ParseIndex(const char *&p, const char *eol, long long &v)
+{
+    while (p < eol && Space(*p)) ++p;
+    if (p >= eol || *p < '0' || *p > '9') return false;
+    v = 0;
+    while (p < eol && *p >= '0' && *p <= '9')
+    {
+        const int d = *p++ - '0';
+        if (v > (LLONG_MAX - d) / 10) return false;
+        v = v * 10 + d;
+    }
+    return true;
+}
+
+/*
+* exact fast path: a mantissa below 2^53 scaled by a power of ten up to 1e22 is correctly rounded by one multiplication or division,
+* other tokens are copied (the mapped file is not null-terminated) and parsed by strtod
+*/
+static inline bool ParseReal(const char *&p, const char *eol, double &v)
+{
+    static const double pow10[23] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    while (p < eol && Space(*p)) ++p;
+    const char *start = p;
+    const char *q = p;
+    bool neg = false;
+    if (q < eol && ('-' == *q || '+' == *q)) neg = ('-' == *q++);
+    unsigned long long m = 0;
+    int digits = 0, scale = 0;
+    for (; q < eol && *q >= '0' && *q <= '9'; ++q, ++digits) m = m * 10 + (*q - '0');
+    if (q < eol && '.' == *q)
+    {
+        for (++q; q < eol && *q >= '0' && *q <= '9'; ++q, ++digits, --scale) m = m * 10 + (*q - '0');
+    }
+    if (q < eol && ('e' == *q || 'E' == *q))
+    {
+        ++q;
+        bool eneg = false;
+        if (q < eol && ('-' == *q || '+' == *q)) eneg = ('-' == *q++);
+        int e = 0;
+        if (q >= eol || *q < '0' || *q > '9') digits = 0;
+        for (; q < eol && *q >= '0' && *q <= '9' && e < 100000; ++q) e = e * 10 + (*q - '0');
+        scale += eneg ? -e : e;
+    }
+    if (digits > 0 && digits <= 19 && m < (1ULL << 53) && scale >= -22 && scale <= 22 && (q >= eol || Space(*q)))
+    {
+        double d = (double)m;
+        d = scale < 0 ? d / pow10[-scale] : d * pow10[scale];
+        v = neg ? -d : d;
+        p = q;
+        return true;
+    }
+
+    p = start;
+    char buf[64];
+    size_t len = 0;
+    while (p < eol && !Space(*p) && len < sizeof(buf) - 1) buf[len++] = *p++;
+    if (0 == len) return false;
+    buf[len] = '\0';
+    char *e;
+    v = strtod(buf, &e);
+    return e == buf + len;
+}
+
+static bool Header(const char *&p, const char *end, MtxField &field, MtxSymmetry &symmetry)
+{
+    const char *eol = LineEnd(p, end);
+    std::string line(p, eol);
+    for (size_t i = 0; i < line.size(); ++i) line[i] = (char)tolower((unsigned char)line[i]);
+    char banner[32], object[32], format[32], f[32], s[32];
+    if (sscanf(line.c_str(), "%31s %31s %31s %31s %31s", banner, object, format, f, s) != 5) return false;
+    if (strcmp(banner, "%%matrixmarket") != 0 || strcmp(object, "matrix") != 0 || strcmp(format, "coordinate") != 0) return false;
+    if (0 == strcmp(f, "real") || 0 == strcmp(f, "integer") || 0 == strcmp(f, "double")) field = MTX_REAL;
+    else if (0 == strcmp(f, "complex")) field = MTX_COMPLEX;
+    else if (0 == strcmp(f, "pattern")) field = MTX_PATTERN;
+    else return false;
+    if (0 == strcmp(s, "general")) symmetry = MTX_GENERAL;
+    else if (0 == strcmp(s, "symmetric")) symmetry = MTX_SYMMETRIC;
+    else if (0 == strcmp(s, "skew-symmetric")) symmetry = MTX_SKEW;
+    else if (0 == strcmp(s, "hermitian")) symmetry = MTX_HERMITIAN;
+    else return false;
+    p = eol < end ? eol + 1 : end;
+    return true;
+}
+
+/*
+* LoaderContext: thread pool kept between calls, the parallel parsing of concurrent calls is serialized by the mutex
+*/
+struct LoaderContext
+{
+    std::mutex mutex;
+    std::unique_ptr<ThreadPool> pool;
+};
+
+static LoaderContext &Context()
+{
+    static LoaderContext context;
+    return context;
+}
+
+/*
+* Loader: parses the entries in parallel chunks of whole lines, then converts COO to compressed storage by counting sort
+* Chunks are counted first, so that every thread parses directly into its part of the COO arrays
+*/
+template <typename Index>
+static int ReadMtx(const char file[], Index *n, Index **ap, Index **ai, double **ax, bool *is_complex, bool csr, int threads)
+{
+    if (NULL == file || NULL == n || NULL == ap || NULL == ai || NULL == ax || NULL == is_complex) return -2;
+    *ap = NULL;
+    *ai = NULL;
+    *ax = NULL;
+
+    MappedFile mf;
+    if (!mf.Open(file)) return -56;
+    const char *p = mf.Data();
+    const char *end = p + mf.Size();
+
+    MtxField field;
+    MtxSymmetry symmetry;
+    if (!Header(p, end, field, symmetry)) return -3;
+
+    /*size line*/
+    long long rows = 0, cols = 0, nz = 0;
+    for (;;)
+    {
+        if (p >= end) return -3;
+        const char *eol = LineEnd(p, end);
+        if (DataLine(p, eol))
+        {
+            if (!ParseIndex(p, eol, rows) || !ParseIndex(p, eol, cols) || !ParseIndex(p, eol, nz)) return -3;
+            p = eol < end ? eol + 1 : end;
+            break;
+        }
+        p = eol < end ? eol + 1 : end;
+    }
+    if (rows != cols || rows <= 0 || nz < 0) return -3;
+    const long long limit = sizeof(Index) < sizeof(long long) ? 0x7fffffffLL : 0x7fffffffffffffffLL;
+    const bool sym = (symmetry != MTX_GENERAL);
+    if (rows > limit || nz > (sym ? limit / 2 : limit)) return -3;
+    const size_t scalar = (MTX_COMPLEX == field) ? 2 : 1;
+
+    int ret = 0;
+    Index *cp = NULL;
+    Index *ci = NULL;
+    double *cx = NULL;
+    try
+    {
+        LoaderContext &context = Context();
+        std::unique_lock<std::mutex> lock(context.mutex);
+        if (!context.pool) context.pool.reset(new ThreadPool(0));
+        ThreadPool &pool = *context.pool;
+        int nt = pool.Threads();
+        if (threads > 0 && threads < nt) nt = threads;
+        const size_t bytes = (size_t)(end - p);
+        if (bytes < (size_t)nt * 65536) nt = (int)(bytes / 65536) + 1;
+
+        /*chunk boundaries at line starts*/
+        std::vector<const char *> bound(nt + 1);
+        bound[0] = p;
+        bound[nt] = end;
+        for (int t = 1; t < nt; ++t)
+        {
+            const char *q = p + bytes / nt * t;
+            if (q < bound[t - 1]) q = bound[t - 1];
+            q = LineEnd(q, end);
+            bound[t] = q < end ? q + 1 : end;
+        }
+
+        std::vector<long long> count(nt + 1, 0);
+        pool.Run(nt, [&](int t)
+        {
+            long long c = 0;
+            for (const char *q = bound[t]; q < bound[t + 1];)
+            {
+                const char *eol = LineEnd(q, bound[t + 1]);
+                if (DataLine(q, eol)) ++c;
+                q = eol + 1;
+            }
+            count[t + 1] = c;
+        });
+        for (int t = 0; t < nt; ++t) count[t + 1] += count[t];
+        if (count[nt] != nz) return -3;
+
+        /*COO, off-diagonal entries of symmetric matrices are mirrored after parsing*/
+        const size_t cap = (size_t)(sym ? 2 * nz : nz);
+        std::vector<Index> row(cap), col(cap);
+        std::vector<double> val(cap * scalar);
+        std::atomic<int> bad(0);
+        pool.Run(nt, [&](int t)
+        {
+            size_t k = (size_t)count[t];
+            for (const char *q = bound[t]; q < bound[t + 1];)
+            {
+                const char *eol = LineEnd(q, bound[t + 1]);
+                if (DataLine(q, eol))
+                {
+                    long long r = 0, c = 0;
+                    bool ok = ParseIndex(q, eol, r) && ParseIndex(q, eol, c) && r >= 1 && r <= rows && c >= 1 && c <= cols;
+                    if (MTX_PATTERN == field)
+                    {
+                        val[k] = 1.;
+                    }
+                    else
+                    {
+                        for (size_t s = 0; s < scalar && ok; ++s) ok = ParseReal(q, eol, val[k * scalar + s]);
+                    }
+                    if (!ok)
+                    {
+                        bad.store(1, std::memory_order_relaxed);
+                        return;
+                    }
+                    row[k] = (Index)(r - 1);
+                    col[k] = (Index)(c - 1);
+                    ++k;
+                }
+                q = eol + 1;
+            }
+        });
+        lock.unlock();
+        if (bad.load()) return -3;
+
+        size_t m = (size_t)nz;
+        if (sym)
+        {
+            for (size_t k = 0; k < (size_t)nz; ++k)
+            {
+                if (row[k] == col[k]) continue;
+                row[m] = col[k];
+                col[m] = row[k];
+                for (size_t s = 0; s < scalar; ++s)
+                {
+                    double v = val[k * scalar + s];
+                    if (MTX_SKEW == symmetry || (MTX_HERMITIAN == symmetry && 1 == s)) v = -v;
+                    val[m * scalar + s] = v;
+                }
+                ++m;
+            }
+        }
+
+        /*counting sort, stable by minor index then by major index, so minor indexes are ascending in each major*/
+        const Index dim = (Index)rows;
+        const std::vector<Index> &major = csr ? row : col;
+        const std::vector<Index> &minor = csr ? col : row;
+        std::vector<size_t> order(m), tmp(m);
+        std::vector<size_t> ptr((size_t)dim + 1);
+        for (size_t k = 0; k < m; ++k) ++ptr[minor[k] + 1];
+        for (Index i = 0; i < dim; ++i) ptr[i + 1] += ptr[i];
+        for (size_t k = 0; k < m; ++k) tmp[ptr[minor[k]]++] = k;
+        std::fill(ptr.begin(), ptr.end(), 0);
+        for (size_t k = 0; k < m; ++k) ++ptr[major[k] + 1];
+        for (Index i = 0; i < dim; ++i) ptr[i + 1] += ptr[i];
+
+        cp = (Index *)malloc(sizeof(Index) * ((size_t)dim + 1));
+        ci = (Index *)malloc(sizeof(Index) * (m > 0 ? m : 1));
+        cx = (double *)malloc(sizeof(double) * scalar * (m > 0 ? m : 1));
+        if (NULL == cp || NULL == ci || NULL == cx) throw std::bad_alloc();
+        for (Index i = 0; i <= dim; ++i) cp[i] = (Index)ptr[i];
+        for (size_t j = 0; j < m; ++j)
+        {
+            const size_t k = tmp[j];
+            order[ptr[major[k]]++] = k;
+        }
+        for (size_t j = 0; j < m; ++j)
+        {
+            const size_t k = order[j];
+            ci[j] = minor[k];
+            for (size_t s = 0; s < scalar; ++s) cx[j * scalar + s] = val[k * scalar + s];
+        }
+    }
+    catch (const std::exception &)
+    {
+        ret = -4;
+    }
+    if (ret != 0)
+    {
+        free(cp);
+        free(ci);
+        free(cx);
+        return ret;
+    }
+
+    *n = (Index)rows;
+    *ap = cp;
+    *ai = ci;
+    *ax = cx;
+    *is_complex = (MTX_COMPLEX == field);
+    return 0;
+}
+
+}
+
+using namespace cktso_host;
+
+int CKTSO_ReadMatrixMarket(const char file[], int *n, int **ap, int **ai, double **ax, bool *is_complex, bool csr, int threads)
+{
+    return ReadMtx<int>(file, n, ap, ai, ax, is_complex, csr, threads);
+}
+
+int CKTSO_L_ReadMatrixMarket(const char file[], long long *n, long long **ap, long long **ai, double **ax, bool *is_complex, bool csr, int threads)
+{
+    return ReadMtx<long long>(file, n, ap, ai, ax, is_complex, csr, threads);
+}
+
+void CKTSO_FreeMatrix(void *ap, void *ai, double *ax)
+{
+    free(ap);
+    free(ai);
+    free(ax);
+}
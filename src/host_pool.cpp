@@ -0,0 +1,77 @@
+#include "host_pool.h"
+
+namespace cktso_host
+{
+
+ThreadPool::ThreadPool(int threads) : job_(NULL), active_(0), pending_(0), round_(0), quit_(false)
+{
+    if (threads <= 0)
+    {
+        threads = (int)std::thread::hardware_concurrency();
+        if (threads <= 0) threads = 1;
+    }
+    workers_.reserve(threads - 1);
+    for (int i = 1; i < threads; ++i)
+    {
+        workers_.push_back(std::thread(&ThreadPool::Worker, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+    }
+    start_.notify_all();
+    for (size_t i = 0; i < workers_.size(); ++i) workers_[i].join();
+}
+
+void ThreadPool::Run(int threads, const std::function<void(int)> &fn)
+{
+    if (threads > Threads()) threads = Threads();
+    if (threads <= 1)
+    {
+        fn(0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &fn;
+        active_ = threads - 1;
+        pending_ = threads - 1;
+        ++round_;
+    }
+    start_.notify_all();
+
+    fn(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (pending_ > 0) done_.wait(lock);
+    job_ = NULL;
+}
+
+void ThreadPool::Worker(int id)
+{
+    unsigned long long seen = 0;
+    for (;;)
+    {
+        const std::function<void(int)> *job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!quit_ && round_ == seen) start_.wait(lock);
+            if (quit_) return;
+            seen = round_;
+            if (id > active_) continue;
+            job = job_;
+        }
+
+        (*job)(id);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--pending_ == 0) done_.notify_one();
+    }
+}
+
+}
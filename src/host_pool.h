@@ -0,0 +1,76 @@
+/*worker threads used by the host accelerator*/
+#ifndef __CKTSO_HOST_POOL__
+#define __CKTSO_HOST_POOL__
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cktso_host
+{
+
+/*
+* SpinBarrier: barrier between bulk levels, all participants spin (with yield) until the last one arrives
+*/
+class SpinBarrier
+{
+public:
+    explicit SpinBarrier(int count) : count_(count), waiting_(0), generation_(0) {}
+
+    void Wait()
+    {
+        const unsigned int gen = generation_.load(std::memory_order_acquire);
+        if (waiting_.fetch_add(1, std::memory_order_acq_rel) + 1 == count_)
+        {
+            waiting_.store(0, std::memory_order_relaxed);
+            generation_.fetch_add(1, std::memory_order_release);
+        }
+        else
+        {
+            while (generation_.load(std::memory_order_acquire) == gen) std::this_thread::yield();
+        }
+    }
+
+private:
+    const int count_;
+    std::atomic<int> waiting_;
+    std::atomic<unsigned int> generation_;
+};
+
+/*
+* ThreadPool: persistent workers, Run() executes fn(tid) for tid = 0 ... threads-1 and returns when all are done
+* tid 0 is executed by the calling thread. Run() is not reentrant.
+*/
+class ThreadPool
+{
+public:
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+
+    int Threads() const
+    {
+        return (int)workers_.size() + 1;
+    }
+
+    void Run(int threads, const std::function<void(int)> &fn);
+
+private:
+    void Worker(int id);
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    const std::function<void(int)> *job_;
+    int active_;
+    int pending_;
+    unsigned long long round_;
+    bool quit_;
+};
+
+}
+
+#endif
@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <complex>
+#include <math.h>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string.h>
+/*AVX2 code is compiled with a target attribute and chosen at run time (see HasAvx2), other compilers need AVX2 enabled*/
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define RESIDUAL_AVX2 __attribute__((target("avx2")))
+#elif defined(__AVX2__)
+#define RESIDUAL_AVX2
+#endif
+#ifdef RESIDUAL_AVX2
+#include <immintrin.h>
+#endif
+#include "../cktso-gpu-host.h"
+#include "host_pool.h"
+
+namespace cktso_host
+{
+
+typedef std::complex<double> cplx;
+
+/*rows per reduction block, fixed so that norms do not depend on #threads*/
+#define RESIDUAL_BLOCK 4096
+
+/*
+* ResidualContext: thread pool and scratch kept between calls, calls are serialized by the mutex
+*/
+struct ResidualContext
+{
+    std::mutex mutex;
+    std::unique_ptr<ThreadPool> pool;
+    std::vector<double> scratch; /*column mode: one zeroed vector per thread*/
+    std::vector<double> partial; /*3 norms per block*/
+};
+
+static ResidualContext &Context()
+{
+    static ResidualContext context;
+    return context;
+}
+
+static inline double Magnitude(double v)
+{
+    return fabs(v);
+}
+
+static inline double Magnitude(const cplx &v)
+{
+    return sqrt(v.real() * v.real() + v.imag() * v.imag());
+}
+
+#ifdef RESIDUAL_AVX2
+static bool HasAvx2()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    static const bool avx2 = __builtin_cpu_supports("avx2") != 0;
+    return avx2;
+#else
+    return true;
+#endif
+}
+
+/*the four lanes are the four accumulators of Dot, added in the same order, so results do not depend on the CPU*/
+template <typename Index>
+RESIDUAL_AVX2 static double DotAvx2(Index start, Index end, const Index ai[], const double ax[], const double x[])
+{
+    Index p = start;
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    __m256d acc = zero;
+    for (; p + 4 <= end; p += 4)
+    {
+        __m256d v;
+        if (sizeof(Index) == 4) v = _mm256_mask_i32gather_pd(zero, x, _mm_loadu_si128((const __m128i *)(ai + p)), all, 8);
+        else v = _mm256_mask_i64gather_pd(zero, x, _mm256_loadu_si256((const __m256i *)(ai + p)), all, 8);
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(ax + p), v));
+    }
+    double a[4];
+    _mm256_storeu_pd(a, acc);
+    double s = (a[0] + a[1]) + (a[2] + a[3]);
+    for (; p < end; ++p) s += ax[p] * x[ai[p]];
+    return s;
+}
+
+/*
+* two complex entries per vector, products of the real and the swapped parts of x, combined by one horizontal add,
+* lanes are re0, im0, re1, im1 of the scalar Dot, in the same order
+*/
+template <typename Index>
+RESIDUAL_AVX2 static cplx DotAvx2(Index start, Index end, const Index ai[], const cplx ax[], const cplx x[])
+{
+    const double *a = (const double *)ax;
+    const double *v = (const double *)x;
+    const __m256d sign = _mm256_set_pd(-0., 0., -0., 0.);
+    __m256d acc = _mm256_setzero_pd();
+    Index p = start;
+    for (; p + 2 <= end; p += 2)
+    {
+        const __m256d xv = _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(v + 2 * ai[p])), _mm_loadu_pd(v + 2 * ai[p + 1]), 1);
+        const __m256d av = _mm256_loadu_pd(a + 2 * p);
+        const __m256d rr = _mm256_xor_pd(_mm256_mul_pd(av, xv), sign);
+        const __m256d ri = _mm256_mul_pd(av, _mm256_permute_pd(xv, 0x5));
+        acc = _mm256_add_pd(acc, _mm256_hadd_pd(rr, ri));
+    }
+    double s[4];
+    _mm256_storeu_pd(s, acc);
+    if (p < end)
+    {
+        const double *x0 = v + 2 * ai[p];
+        const double *a0 = a + 2 * p;
+        s[0] += a0[0] * x0[0] - a0[1] * x0[1];
+        s[1] += a0[0] * x0[1] + a0[1] * x0[0];
+    }
+    return cplx(s[0] + s[2], s[1] + s[3]);
+}
+#endif
+
+/*sum of ax[p] * x[ai[p]] over [start, end), four independent accumulators*/
+template <typename Index>
+static inline double Dot(Index start, Index end, const Index ai[], const double ax[], const double x[])
+{
+#ifdef RESIDUAL_AVX2
+    if (end - start >= 4 && HasAvx2()) return DotAvx2(start, end, ai, ax, x);
+#endif
+    Index p = start;
+    double a[4] = {0., 0., 0., 0.};
+    for (; p + 4 <= end; p += 4)
+    {
+        a[0] += ax[p] * x[ai[p]];
+        a[1] += ax[p + 1] * x[ai[p + 1]];
+        a[2] += ax[p + 2] * x[ai[p + 2]];
+        a[3] += ax[p + 3] * x[ai[p + 3]];
+    }
+    double s = (a[0] + a[1]) + (a[2] + a[3]);
+    for (; p < end; ++p) s += ax[p] * x[ai[p]];
+    return s;
+}
+
+/*complex products are expanded, std::complex multiplication also checks for NaN*/
+template <typename Index>
+static inline cplx Dot(Index start, Index end, const Index ai[], const cplx ax[], const cplx x[])
+{
+#ifdef RESIDUAL_AVX2
+    if (end - start >= 2 && HasAvx2()) return DotAvx2(start, end, ai, ax, x);
+#endif
+    const double *a = (const double *)ax;
+    const double *v = (const double *)x;
+    double re0 = 0., im0 = 0., re1 = 0., im1 = 0.;
+    Index p = start;
+    for (; p + 2 <= end; p += 2)
+    {
+        const double *x0 = v + 2 * ai[p];
+        const double *x1 = v + 2 * ai[p + 1];
+        const double *a0 = a + 2 * p;
+        re0 += a0[0] * x0[0] - a0[1] * x0[1];
+        im0 += a0[0] * x0[1] + a0[1] * x0[0];
+        re1 += a0[2] * x1[0] - a0[3] * x1[1];
+        im1 += a0[2] * x1[1] + a0[3] * x1[0];
+    }
+    if (p < end)
+    {
+        const double *x0 = v + 2 * ai[p];
+        const double *a0 = a + 2 * p;
+        re0 += a0[0] * x0[0] - a0[1] * x0[1];
+        im0 += a0[0] * x0[1] + a0[1] * x0[0];
+    }
+    return cplx(re0 + re1, im0 + im1);
+}
+
+/*residual rows [start, end) with their 1-norm, squared 2-norm and inf-norm, scratch holds the column mode products*/
+template <typename T, typename Index>
+static void Block(Index start, Index end, Index n, const Index ap[], const Index ai[], const T ax[], const T x[], const T b[], T r[],
+    bool row0_column1, int threads, T scratch[], double norm[3])
+{
+    double n1 = 0., n2 = 0., ninf = 0.;
+    for (Index i = start; i < end; ++i)
+    {
+        T v = b[i];
+        if (row0_column1)
+        {
+            for (int t = 0; t < threads; ++t)
+            {
+                T &s = scratch[(size_t)t * n + i];
+                v -= s;
+                s = T(0.);
+            }
+        }
+        else
+        {
+            v -= Dot(ap[i], ap[i + 1], ai, ax, x);
+        }
+        if (r != NULL) r[i] = v;
+        const double m = Magnitude(v);
+        n1 += m;
+        n2 += m * m;
+        ninf = m > ninf ? m : ninf;
+    }
+    norm[0] = n1;
+    norm[1] = n2;
+    norm[2] = ninf;
+}
+
+/*
+* r = b - M * x in row mode, r = b - M^T * x in column mode
+* row mode rows are independent, column mode scatters into a private vector per thread, reduced in thread order
+*/
+template <typename T, typename Index>
+static void ResidualT(Index n, const Index ap[], const Index ai[], const T ax[], const T x[], const T b[], T r[],
+    double norms[3], bool row0_column1, ThreadPool &pool, int threads, T scratch[], double partial[])
+{
+    const Index blocks = (n + RESIDUAL_BLOCK - 1) / RESIDUAL_BLOCK;
+    if (row0_column1)
+    {
+        const Index chunk = (n + threads - 1) / threads;
+        pool.Run(threads, [=](int tid)
+        {
+            T *s = scratch + (size_t)tid * n;
+            const Index start = chunk * tid;
+            const Index end = std::min(n, start + chunk);
+            for (Index i = start; i < end; ++i)
+            {
+                const T xi = x[i];
+                for (Index p = ap[i]; p < ap[i + 1]; ++p) s[ai[p]] += ax[p] * xi;
+            }
+        });
+    }
+
+    std::atomic<Index> next(0);
+    pool.Run(threads, [=, &next](int)
+    {
+        for (;;)
+        {
+            const Index blk = next.fetch_add(1, std::memory_order_relaxed);
+            if (blk >= blocks) break;
+            const Index start = blk * RESIDUAL_BLOCK;
+            const Index end = std::min(n, start + RESIDUAL_BLOCK);
+            Block(start, end, n, ap, ai, ax, x, b, r, row0_column1, threads, scratch, partial + 3 * blk);
+        }
+    });
+
+    double n1 = 0., n2 = 0., ninf = 0.;
+    for (Index blk = 0; blk < blocks; ++blk)
+    {
+        n1 += partial[3 * blk];
+        n2 += partial[3 * blk + 1];
+        if (partial[3 * blk + 2] > ninf) ninf = partial[3 * blk + 2];
+    }
+    norms[0] = n1;
+    norms[1] = sqrt(n2);
+    norms[2] = ninf;
+}
+
+template <typename Index>
+static int Residual(bool is_complex, Index n, const Index ap[], const Index ai[], const double ax[], const double x[], const double b[],
+    double r[], double norms[], bool row0_column1, int threads)
+{
+    if (n <= 0 || NULL == ap || NULL == ai || NULL == ax || NULL == x || NULL == b || NULL == norms) return -2;
+    if (ap[n] < 0) return -3;
+    ResidualContext &context = Context();
+    std::lock_guard<std::mutex> lock(context.mutex);
+    try
+    {
+        if (!context.pool) context.pool.reset(new ThreadPool(0));
+        const int max = context.pool->Threads();
+        if (threads <= 0 || threads > max) threads = max;
+        const size_t scalar = is_complex ? 2 : 1;
+        const size_t blocks = (size_t)((n + RESIDUAL_BLOCK - 1) / RESIDUAL_BLOCK);
+        if ((size_t)threads > blocks) threads = (int)blocks;
+        if (context.partial.size() < 3 * blocks) context.partial.resize(3 * blocks);
+        const size_t ssize = row0_column1 ? (size_t)threads * (size_t)n * scalar : 0;
+        if (context.scratch.size() < ssize) context.scratch.assign(ssize, 0.);
+    }
+    catch (const std::bad_alloc &)
+    {
+        return -4;
+    }
+
+    double *scratch = context.scratch.empty() ? NULL : &context.scratch[0];
+    if (is_complex) ResidualT<cplx, Index>(n, ap, ai, (const cplx *)ax, (const cplx *)x, (const cplx *)b, (cplx *)r,
+        norms, row0_column1, *context.pool, threads, (cplx *)scratch, &context.partial[0]);
+    else ResidualT<double, Index>(n, ap, ai, ax, x, b, r, norms, row0_column1, *context.pool, threads, scratch, &context.partial[0]);
+    return 0;
+}
+
+}
+
+using namespace cktso_host;
+
+int CKTSO_Residual(bool is_complex, int n, const int ap[], const int ai[], const double ax[], const double x[], const double b[],
+    double r[], double norms[], bool row0_column1, int threads)
+{
+    return Residual<int>(is_complex, n, ap, ai, ax, x, b, r, norms, row0_column1, threads);
+}
+
+int CKTSO_L_Residual(bool is_complex, long long n, const long long ap[], const long long ai[], const double ax[], const double x[], const double b[],
+    double r[], double norms[], bool row0_column1, int threads)
+{
+    return Residual<long long>(is_complex, n, ap, ai, ax, x, b, r, norms, row0_column1, threads);
+}
@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <vector>
+#include "host_accel.h"
+
+namespace cktso_host
+{
+
+/*summary, and width and flops of each level*/
+static void Analyze(const Symbolic &s, CKTSO_GPU_SCHEDULE *r, std::vector<long long> &width, std::vector<long long> &flops)
+{
+    const idx_t n = s.n;
+    const idx_t levels = s.Levels();
+    width.assign(levels, 0);
+    flops.assign(levels, 0);
+
+    /*columns are in topological order, each depending on columns before it only*/
+    std::vector<long long> chain(n);
+    long long critical = 0, edges = 0;
+    for (idx_t k = 0; k < n; ++k)
+    {
+        const long long f = s.ColumnFlops(k);
+        long long before = 0;
+        for (idx_t p = s.cp[k]; p < s.dpos[k]; ++p)
+        {
+            if (chain[s.ci[p]] > before) before = chain[s.ci[p]];
+        }
+        chain[k] = before + f;
+        if (chain[k] > critical) critical = chain[k];
+        edges += s.dpos[k] - s.cp[k];
+        flops[s.level[k]] += f;
+    }
+
+    r->n = n;
+    r->levels = levels;
+    r->bulk_levels = s.nbulk;
+    r->bulk_columns = s.lvptr[s.nbulk];
+    r->max_width = 0;
+    r->flops = 0;
+    for (idx_t l = 0; l < levels; ++l)
+    {
+        width[l] = s.lvptr[l + 1] - s.lvptr[l];
+        if (width[l] > r->max_width) r->max_width = width[l];
+        r->flops += flops[l];
+    }
+    r->edges = edges;
+    r->critical_flops = critical;
+    r->parallelism = critical > 0 ? (double)r->flops / critical : 1.;
+}
+
+static void Report(FILE *fp, const Symbolic &s)
+{
+    CKTSO_GPU_SCHEDULE r;
+    std::vector<long long> width, flops;
+    Analyze(s, &r, width, flops);
+    fprintf(fp, "n = %lld, factor nnz = %lld, dependencies = %lld\n", r.n, (long long)s.FactorNnz(), r.edges);
+    fprintf(fp, "levels = %lld (critical path in columns), widest level = %lld columns, mean width = %.1f\n", r.levels, r.max_width, (double)r.n / r.levels);
+    fprintf(fp, "refactor flops = %lld, critical path flops = %lld, parallelism = %.2f\n", r.flops, r.critical_flops, r.parallelism);
+    fprintf(fp, "bulk mode: %lld levels, %lld columns (%.1f%%), pipeline mode: %lld levels\n", r.bulk_levels, r.bulk_columns,
+        100. * r.bulk_columns / r.n, r.levels - r.bulk_levels);
+
+    /*what the cutover would be for other bulk thresholds*/
+    fprintf(fp, "\n%10s %12s %12s %12s\n", "iparm[1]", "bulk levels", "bulk cols", "bulk flops%");
+    const int thresholds[] = { 1, 8, 32, 128, 512, 2048 };
+    for (size_t t = 0; t < sizeof(thresholds) / sizeof(thresholds[0]); ++t)
+    {
+        long long l = 0, cols = 0, f = 0;
+        while (l < r.levels && width[l] >= thresholds[t])
+        {
+            cols += width[l];
+            f += flops[l];
+            ++l;
+        }
+        fprintf(fp, "%10d %12lld %12lld %12.1f\n", thresholds[t], l, cols, r.flops > 0 ? 100. * f / r.flops : 0.);
+    }
+
+    /*levels by width, in powers of 2*/
+    fprintf(fp, "\n%-20s %12s %12s %12s\n", "level width", "levels", "columns", "flops%");
+    for (long long lo = 1; lo <= r.max_width; lo *= 2)
+    {
+        long long count = 0, cols = 0, f = 0;
+        for (idx_t l = 0; l < r.levels; ++l)
+        {
+            if (width[l] >= lo && width[l] < 2 * lo)
+            {
+                ++count;
+                cols += width[l];
+                f += flops[l];
+            }
+        }
+        if (0 == count) continue;
+        char range[32];
+        snprintf(range, sizeof(range), "[%lld, %lld)", lo, 2 * lo);
+        fprintf(fp, "%-20s %12lld %12lld %12.1f\n", range, count, cols, r.flops > 0 ? 100. * f / r.flops : 0.);
+    }
+
+    fprintf(fp, "\n%10s %12s %16s %s\n", "level", "width", "flops", "mode");
+    for (idx_t l = 0; l < r.levels; ++l)
+    {
+        fprintf(fp, "%10lld %12lld %16lld %s\n", (long long)l, width[l], flops[l], l < r.bulk_levels ? "bulk" : "pipeline");
+    }
+}
+
+static void Dot(FILE *fp, const Symbolic &s)
+{
+    fprintf(fp, "digraph cktso {\n  rankdir=TB;\n  node [shape=circle, fontsize=8];\n");
+    for (idx_t l = 0; l < s.Levels(); ++l)
+    {
+        fprintf(fp, "  { rank=same;\n");
+        for (idx_t i = s.lvptr[l]; i < s.lvptr[l + 1]; ++i)
+        {
+            const idx_t k = s.lvcol[i];
+            fprintf(fp, "    c%lld [label=\"%lld\\nrow %lld\"%s];\n", (long long)k, (long long)k, (long long)s.q[k], l < s.nbulk ? ", style=filled" : "");
+        }
+        fprintf(fp, "  }\n");
+    }
+    for (idx_t k = 0; k < s.n; ++k)
+    {
+        for (idx_t p = s.cp[k]; p < s.dpos[k]; ++p) fprintf(fp, "  c%lld -> c%lld;\n", (long long)s.ci[p], (long long)k);
+    }
+    fprintf(fp, "}\n");
+}
+
+static void Edges(FILE *fp, const Symbolic &s)
+{
+    fprintf(fp, "from,to\n");
+    for (idx_t k = 0; k < s.n; ++k)
+    {
+        for (idx_t p = s.cp[k]; p < s.dpos[k]; ++p) fprintf(fp, "%lld,%lld\n", (long long)s.ci[p], (long long)k);
+    }
+}
+
+template <typename Accel, typename HostType>
+static int GetSchedule(Accel *accel, CKTSO_GPU_SCHEDULE *schedule, long long width[], long long flops[], long long size)
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    if (NULL == a) return -55;
+    if (NULL == schedule || size < 0 || (size > 0 && NULL == width && NULL == flops)) return -2;
+    const Symbolic *s = a->Structure();
+    if (NULL == s) return -52;
+    std::vector<long long> w, f;
+    try
+    {
+        Analyze(*s, schedule, w, f);
+    }
+    catch (const std::bad_alloc &)
+    {
+        return -4;
+    }
+    for (long long l = 0; l < size && l < schedule->levels; ++l)
+    {
+        if (width != NULL) width[l] = w[l];
+        if (flops != NULL) flops[l] = f[l];
+    }
+    return 0;
+}
+
+template <typename Accel, typename HostType>
+static int DumpSchedule(Accel *accel, const char file[], int format)
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    if (NULL == a) return -55;
+    if (format < 0 || format > 2) return -2;
+    const Symbolic *s = a->Structure();
+    if (NULL == s) return -52;
+    FILE *fp = NULL == file ? stdout : fopen(file, "w");
+    if (NULL == fp) return -56;
+    int ret = 0;
+    try
+    {
+        if (0 == format) Report(fp, *s);
+        else if (1 == format) Dot(fp, *s);
+        else Edges(fp, *s);
+    }
+    catch (const std::bad_alloc &)
+    {
+        ret = -4;
+    }
+    bool ok = ferror(fp) == 0;
+    if (fp != stdout) ok = (fclose(fp) == 0) && ok;
+    else fflush(fp);
+    return 0 == ret && !ok ? -56 : ret;
+}
+
+}
+
+using namespace cktso_host;
+
+int CKTSO_GpuGetSchedule(ICktSoGpu accel, CKTSO_GPU_SCHEDULE *schedule, long long width[], long long flops[], long long size)
+{
+    return GetSchedule<__CKTSO_GPU, HostAccel>(accel, schedule, width, flops, size);
+}
+
+int CKTSO_L_GpuGetSchedule(ICktSoGpu_L accel, CKTSO_GPU_SCHEDULE *schedule, long long width[], long long flops[], long long size)
+{
+    return GetSchedule<__CKTSO_L_GPU, HostAccel_L>(accel, schedule, width, flops, size);
+}
+
+int CKTSO_GpuDumpSchedule(ICktSoGpu accel, const char file[], int format)
+{
+    return DumpSchedule<__CKTSO_GPU, HostAccel>(accel, file, format);
+}
+
+int CKTSO_L_GpuDumpSchedule(ICktSoGpu_L accel, const char file[], int format)
+{
+    return DumpSchedule<__CKTSO_L_GPU, HostAccel_L>(accel, file, format);
+}
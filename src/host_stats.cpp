@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include "host_accel.h"
+
+namespace cktso_host
+{
+
+static const char *phases[CKTSO_STATS_PHASES] =
+{
+    "SetHostMatrix", "InitializeGpuAccelerator", "GpuRefactorize", "GpuSolve", "GpuSolveMany",
+    "GpuRefactorizeAndSolve", "GpuRefactorizeDelta", "GpuRefactorizeMasked", "GpuRefactorizeBatch", "GpuSolveBatch",
+    "GpuSolveSparse", "GpuFrequencySweep"
+};
+
+/*lower bound (in ns) of a histogram bin*/
+static double Lower(int k)
+{
+    if (k < 2) return (double)k;
+    const double p = (double)(1ULL << (k / 2));
+    return (k & 1) ? 1.5 * p : p;
+}
+
+/*lower bound of the bin holding quantile q*/
+static double Quantile(const long long hist[], double q)
+{
+    long long all = 0;
+    for (int k = 0; k < CKTSO_STATS_BINS; ++k) all += hist[k];
+    long long sum = 0;
+    for (int k = 0; k < CKTSO_STATS_BINS; ++k)
+    {
+        sum += hist[k];
+        if (all > 0 && sum >= q * all) return Lower(k);
+    }
+    return 0.;
+}
+
+static void Histogram(FILE *fp, const char name[], const long long hist[])
+{
+    long long all = 0;
+    for (int k = 0; k < CKTSO_STATS_BINS; ++k) all += hist[k];
+    if (0 == all) return;
+    fprintf(fp, "%s latency: %lld calls, median >= %.3f us, p99 >= %.3f us\n", name, all, Quantile(hist, .5) * 1e-3, Quantile(hist, .99) * 1e-3);
+    for (int k = 0; k < CKTSO_STATS_BINS; ++k)
+    {
+        if (0 == hist[k]) continue;
+        if (k + 1 < CKTSO_STATS_BINS) fprintf(fp, "  [%12.3f, %12.3f) us %12lld\n", Lower(k) * 1e-3, Lower(k + 1) * 1e-3, hist[k]);
+        else fprintf(fp, "  [%12.3f,          inf) us %12lld\n", Lower(k) * 1e-3, hist[k]);
+    }
+}
+
+template <typename Accel, typename HostType>
+static int GetStats(Accel *accel, CKTSO_GPU_STATS *stats, bool reset)
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    if (NULL == a) return -55;
+    if (NULL == stats) return -2;
+    a->GetStats(stats, reset);
+    return 0;
+}
+
+}
+
+using namespace cktso_host;
+
+int CKTSO_GpuGetStats(ICktSoGpu accel, CKTSO_GPU_STATS *stats, bool reset)
+{
+    return GetStats<__CKTSO_GPU, HostAccel>(accel, stats, reset);
+}
+
+int CKTSO_L_GpuGetStats(ICktSoGpu_L accel, CKTSO_GPU_STATS *stats, bool reset)
+{
+    return GetStats<__CKTSO_L_GPU, HostAccel_L>(accel, stats, reset);
+}
+
+int CKTSO_DumpStats(const CKTSO_GPU_STATS *stats, const char file[])
+{
+    if (NULL == stats) return -2;
+    FILE *fp = NULL == file ? stdout : fopen(file, "a");
+    if (NULL == fp) return -56;
+    fprintf(fp, "%-26s %12s %14s %14s %14s\n", "routine", "calls", "total (us)", "mean (us)", "max (us)");
+    for (int p = 0; p < CKTSO_STATS_PHASES; ++p)
+    {
+        const long long calls = stats->calls[p];
+        if (0 == calls) continue;
+        fprintf(fp, "%-26s %12lld %14.3f %14.3f %14.3f\n", phases[p], calls, stats->total_ns[p] * 1e-3,
+            stats->total_ns[p] * 1e-3 / calls, stats->max_ns[p] * 1e-3);
+    }
+    fprintf(fp, "bytes in %lld, bytes out %lld, bypassed refactors %lld, re-initializations %lld (incremental %lld), cache hits %lld\n",
+        stats->bytes_in, stats->bytes_out, stats->bypassed, stats->reinitializations, stats->incremental, stats->cache_hits);
+    Histogram(fp, "refactor", stats->refactor_hist);
+    Histogram(fp, "solve", stats->solve_hist);
+    bool ok = ferror(fp) == 0;
+    if (fp != stdout) ok = (fclose(fp) == 0) && ok;
+    else fflush(fp);
+    return ok ? 0 : -56;
+}
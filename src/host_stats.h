@@ -0,0 +1,136 @@
+/*counters and latency histograms of a host accelerator instance*/
+#ifndef __CKTSO_HOST_STATS__
+#define __CKTSO_HOST_STATS__
+
+#include <atomic>
+#include <chrono>
+#include "../cktso-gpu-host.h"
+
+namespace cktso_host
+{
+
+/*
+* Counters: updated with relaxed atomics, so that another thread can read or reset them while the instance is running
+*/
+class Counters
+{
+public:
+    Counters()
+    {
+        Clear();
+    }
+
+    static long long Now()
+    {
+        return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /*histogram bin of a latency, see CKTSO_GPU_STATS*/
+    static int Bin(long long ns)
+    {
+        if (ns < 2) return ns < 1 ? 0 : 1;
+        int msb = 0;
+        for (int s = 32; s > 0; s >>= 1)
+        {
+            if (ns >> (msb + s)) msb += s;
+        }
+        const int k = 2 * msb + (int)((ns >> (msb - 1)) & 1);
+        return k < CKTSO_STATS_BINS ? k : CKTSO_STATS_BINS - 1;
+    }
+
+    /*hist: 0 none, 1 refactor, 2 solve*/
+    void Add(int phase, long long ns, int hist)
+    {
+        calls_[phase].fetch_add(1, std::memory_order_relaxed);
+        total_[phase].fetch_add(ns, std::memory_order_relaxed);
+        long long max = max_[phase].load(std::memory_order_relaxed);
+        while (ns > max && !max_[phase].compare_exchange_weak(max, ns, std::memory_order_relaxed)) {}
+        if (1 == hist) refactor_[Bin(ns)].fetch_add(1, std::memory_order_relaxed);
+        else if (2 == hist) solve_[Bin(ns)].fetch_add(1, std::memory_order_relaxed);
+    }
+    void In(long long bytes)
+    {
+        in_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    void Out(long long bytes)
+    {
+        out_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    void Bypassed()
+    {
+        bypassed_.fetch_add(1, std::memory_order_relaxed);
+    }
+    /*again: re-initialization, incremental: the ordering was kept, hit: restored from the cache*/
+    void Initialized(bool again, bool incremental, bool hit)
+    {
+        if (again) reinit_.fetch_add(1, std::memory_order_relaxed);
+        if (incremental) incremental_.fetch_add(1, std::memory_order_relaxed);
+        if (hit) hits_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /*Get: copies the counters, and clears them when reset (each counter is read and cleared atomically, not all at once)*/
+    void Get(CKTSO_GPU_STATS *s, bool reset)
+    {
+        for (int p = 0; p < CKTSO_STATS_PHASES; ++p)
+        {
+            s->calls[p] = Take(calls_[p], reset);
+            s->total_ns[p] = Take(total_[p], reset);
+            s->max_ns[p] = Take(max_[p], reset);
+        }
+        s->bytes_in = Take(in_, reset);
+        s->bytes_out = Take(out_, reset);
+        s->bypassed = Take(bypassed_, reset);
+        s->reinitializations = Take(reinit_, reset);
+        s->incremental = Take(incremental_, reset);
+        s->cache_hits = Take(hits_, reset);
+        for (int k = 0; k < CKTSO_STATS_BINS; ++k)
+        {
+            s->refactor_hist[k] = Take(refactor_[k], reset);
+            s->solve_hist[k] = Take(solve_[k], reset);
+        }
+    }
+
+private:
+    static long long Take(std::atomic<long long> &v, bool reset)
+    {
+        return reset ? v.exchange(0, std::memory_order_relaxed) : v.load(std::memory_order_relaxed);
+    }
+    void Clear()
+    {
+        CKTSO_GPU_STATS s;
+        Get(&s, true);
+    }
+
+    std::atomic<long long> calls_[CKTSO_STATS_PHASES];
+    std::atomic<long long> total_[CKTSO_STATS_PHASES];
+    std::atomic<long long> max_[CKTSO_STATS_PHASES];
+    std::atomic<long long> in_, out_, bypassed_, reinit_, incremental_, hits_;
+    std::atomic<long long> refactor_[CKTSO_STATS_BINS];
+    std::atomic<long long> solve_[CKTSO_STATS_BINS];
+};
+
+/*
+* StatScope: adds the latency of its scope to a phase
+*/
+class StatScope
+{
+public:
+    StatScope(Counters &c, int phase, int hist = 0) : c_(c), phase_(phase), hist_(hist), start_(Counters::Now()) {}
+    ~StatScope()
+    {
+        c_.Add(phase_, Counters::Now() - start_, hist_);
+    }
+
+private:
+    StatScope(const StatScope &);
+    StatScope &operator=(const StatScope &);
+
+    Counters &c_;
+    const int phase_;
+    const int hist_;
+    const long long start_;
+};
+
+}
+
+#endif
@@ -0,0 +1,199 @@
+#include <map>
+#include <new>
+#include <set>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include "host_accel.h"
+
+namespace cktso_host
+{
+
+/*
+* binary trace, native byte order:
+* TraceHeader, then names (each a 32-bit length and the characters), then events TraceRecord, oldest first
+*/
+#define TRACE_VERSION 1
+#define TRACE_NONE    0xffffffffu
+
+struct TraceHeader
+{
+    char magic[8]; /*"CKTSOTRC"*/
+    unsigned int version;
+    unsigned int names;
+    unsigned long long events;
+};
+
+struct TraceRecord
+{
+    long long start, dur, arg;
+    unsigned int name, label; /*indexes of the name table, TRACE_NONE for no label*/
+    int tid;
+    unsigned int reserved;
+};
+
+static void Escaped(FILE *fp, const std::string &s)
+{
+    for (size_t i = 0; i < s.size(); ++i)
+    {
+        const unsigned char c = (unsigned char)s[i];
+        if ('"' == c || '\\' == c) fprintf(fp, "\\%c", c);
+        else if (c < 0x20) fprintf(fp, "\\u%04x", c);
+        else fputc(c, fp);
+    }
+}
+
+/*Chrome trace JSON: complete ("X") events in microseconds, and one name per thread*/
+static bool WriteJson(const char file[], const std::vector<std::string> &names, const std::vector<TraceRecord> &records)
+{
+    FILE *fp = fopen(file, "w");
+    if (NULL == fp) return false;
+    fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    std::set<int> tids;
+    for (size_t i = 0; i < records.size(); ++i) tids.insert(records[i].tid);
+    bool first = true;
+    for (std::set<int>::const_iterator t = tids.begin(); t != tids.end(); ++t)
+    {
+        fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}",
+            first ? "" : ",\n", *t, 0 == *t ? "caller" : "worker", *t);
+        first = false;
+    }
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        const TraceRecord &r = records[i];
+        fprintf(fp, "%s{\"name\":\"", first ? "" : ",\n");
+        first = false;
+        Escaped(fp, r.name < names.size() ? names[r.name] : std::string("?"));
+        fprintf(fp, "\",\"cat\":\"cktso\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f", r.tid, r.start * 1e-3, r.dur * 1e-3);
+        if (r.label < names.size())
+        {
+            fprintf(fp, ",\"args\":{\"");
+            Escaped(fp, names[r.label]);
+            fprintf(fp, "\":%lld}", r.arg);
+        }
+        fputc('}', fp);
+    }
+    fprintf(fp, "\n]}\n");
+    return fclose(fp) == 0;
+}
+
+static bool WriteBinary(const char file[], const std::vector<std::string> &names, const std::vector<TraceRecord> &records)
+{
+    FILE *fp = fopen(file, "wb");
+    if (NULL == fp) return false;
+    TraceHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "CKTSOTRC", 8);
+    h.version = TRACE_VERSION;
+    h.names = (unsigned int)names.size();
+    h.events = records.size();
+    bool ok = fwrite(&h, sizeof(h), 1, fp) == 1;
+    for (size_t i = 0; i < names.size() && ok; ++i)
+    {
+        const unsigned int len = (unsigned int)names[i].size();
+        ok = fwrite(&len, sizeof(len), 1, fp) == 1 && fwrite(names[i].data(), 1, len, fp) == len;
+    }
+    ok = ok && (records.empty() || fwrite(&records[0], sizeof(TraceRecord), records.size(), fp) == records.size());
+    return (fclose(fp) == 0) && ok;
+}
+
+int Tracer::Dump(const char file[], bool binary) const
+{
+    const unsigned long long head = Recorded();
+    const size_t cap = events_.size();
+    const size_t count = head < cap ? (size_t)head : cap;
+    std::vector<std::string> names;
+    std::vector<TraceRecord> records(count);
+    std::map<const char *, unsigned int> index;
+    auto id = [&](const char *s) -> unsigned int
+    {
+        if (NULL == s) return TRACE_NONE;
+        std::map<const char *, unsigned int>::const_iterator it = index.find(s);
+        if (it != index.end()) return it->second;
+        const unsigned int k = (unsigned int)names.size();
+        names.push_back(s);
+        index[s] = k;
+        return k;
+    };
+    for (size_t i = 0; i < count; ++i)
+    {
+        const TraceEvent &e = events_[(head - count + i) % cap];
+        TraceRecord &r = records[i];
+        r.start = e.start;
+        r.dur = e.dur;
+        r.arg = e.arg;
+        r.name = id(e.name);
+        r.label = id(e.label);
+        r.tid = e.tid;
+        r.reserved = 0;
+    }
+    const bool ok = binary ? WriteBinary(file, names, records) : WriteJson(file, names, records);
+    return ok ? 0 : -56;
+}
+
+template <typename Accel, typename HostType>
+static int DumpTrace(Accel *accel, const char file[], bool binary, bool clear)
+{
+    if (NULL == accel) return -1;
+    HostType *a = dynamic_cast<HostType *>(accel);
+    if (NULL == a) return -55;
+    if (NULL == file) return -2;
+    return a->DumpTrace(file, binary, clear);
+}
+
+}
+
+using namespace cktso_host;
+
+int CKTSO_GpuDumpTrace(ICktSoGpu accel, const char file[], bool binary, bool clear)
+{
+    return DumpTrace<__CKTSO_GPU, HostAccel>(accel, file, binary, clear);
+}
+
+int CKTSO_L_GpuDumpTrace(ICktSoGpu_L accel, const char file[], bool binary, bool clear)
+{
+    return DumpTrace<__CKTSO_L_GPU, HostAccel_L>(accel, file, binary, clear);
+}
+
+int CKTSO_ConvertTrace(const char binary[], const char json[])
+{
+    if (NULL == binary || NULL == json) return -2;
+    FILE *fp = fopen(binary, "rb");
+    if (NULL == fp) return -56;
+    TraceHeader h;
+    bool ok = fread(&h, sizeof(h), 1, fp) == 1 && memcmp(h.magic, "CKTSOTRC", 8) == 0 && TRACE_VERSION == h.version;
+    std::vector<std::string> names;
+    std::vector<TraceRecord> records;
+    try
+    {
+        for (unsigned int i = 0; i < h.names && ok; ++i)
+        {
+            unsigned int len;
+            ok = fread(&len, sizeof(len), 1, fp) == 1 && len < 4096;
+            if (!ok) break;
+            std::string s(len, '\0');
+            ok = 0 == len || fread(&s[0], 1, len, fp) == len;
+            names.push_back(s);
+        }
+        if (ok)
+        {
+            /*the event count is checked against the file size before anything is allocated*/
+            const long pos = ftell(fp);
+            ok = pos >= 0 && fseek(fp, 0, SEEK_END) == 0 && (unsigned long long)(ftell(fp) - pos) == h.events * sizeof(TraceRecord)
+                && fseek(fp, pos, SEEK_SET) == 0;
+        }
+        if (ok)
+        {
+            records.resize((size_t)h.events);
+            ok = records.empty() || fread(&records[0], sizeof(TraceRecord), records.size(), fp) == records.size();
+        }
+    }
+    catch (const std::bad_alloc &)
+    {
+        fclose(fp);
+        return -4;
+    }
+    fclose(fp);
+    if (!ok) return -3;
+    return WriteJson(json, names, records) ? 0 : -56;
+}
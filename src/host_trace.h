@@ -0,0 +1,102 @@
+/*timeline tracing of the host accelerator phases*/
+#ifndef __CKTSO_HOST_TRACE__
+#define __CKTSO_HOST_TRACE__
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace cktso_host
+{
+
+/*
+* TraceEvent: one span, name and label are string literals, arg is the value of label (e.g., a level index), -1 for none
+*/
+struct TraceEvent
+{
+    long long start, dur; /*nanoseconds since the tracer was created*/
+    const char *name;
+    const char *label;
+    long long arg;
+    int tid; /*thread pool index, 0 for the calling thread*/
+};
+
+/*
+* Tracer: ring buffer of spans, recorded without locks by any thread; once full, the oldest spans are overwritten
+* Dump and Reset must not run concurrently with recording
+*/
+class Tracer
+{
+public:
+    explicit Tracer(size_t capacity) : events_(capacity), head_(0), epoch_(std::chrono::steady_clock::now()) {}
+
+    size_t Capacity() const
+    {
+        return events_.size();
+    }
+    long long Now() const
+    {
+        return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch_).count();
+    }
+    void Record(const char *name, const char *label, long long arg, int tid, long long start)
+    {
+        const long long end = Now();
+        TraceEvent &e = events_[head_.fetch_add(1, std::memory_order_relaxed) % events_.size()];
+        e.start = start;
+        e.dur = end - start;
+        e.name = name;
+        e.label = label;
+        e.arg = arg;
+        e.tid = tid;
+    }
+    /*#spans recorded, including overwritten ones*/
+    unsigned long long Recorded() const
+    {
+        return head_.load(std::memory_order_relaxed);
+    }
+    void Reset()
+    {
+        head_.store(0, std::memory_order_relaxed);
+    }
+
+    /*
+    * Dump: writes the spans kept in the ring, oldest first
+    * @binary: false for Chrome trace JSON (chrome://tracing, Perfetto), true for the compact format read by ConvertTrace
+    * returns 0 or -56 (file cannot be written)
+    */
+    int Dump(const char file[], bool binary) const;
+
+private:
+    std::vector<TraceEvent> events_;
+    std::atomic<unsigned long long> head_;
+    const std::chrono::steady_clock::time_point epoch_;
+};
+
+/*
+* TraceSpan: records the span of its scope, does nothing (not even reading the clock) when the tracer is NULL
+*/
+class TraceSpan
+{
+public:
+    TraceSpan(Tracer *trace, const char *name, int tid = 0, const char *label = NULL, long long arg = -1) :
+        trace_(trace), name_(name), label_(label), arg_(arg), tid_(tid), start_(trace != NULL ? trace->Now() : 0) {}
+    ~TraceSpan()
+    {
+        if (trace_ != NULL) trace_->Record(name_, label_, arg_, tid_, start_);
+    }
+
+private:
+    TraceSpan(const TraceSpan &);
+    TraceSpan &operator=(const TraceSpan &);
+
+    Tracer *const trace_;
+    const char *const name_;
+    const char *const label_;
+    const long long arg_;
+    const int tid_;
+    const long long start_;
+};
+
+}
+
+#endif
@@ -0,0 +1,317 @@
+#include <chrono>
+#include <limits.h>
+#include <new>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+#include "host_accel.h"
+
+namespace cktso_host
+{
+
+/*timed calls per candidate, the best one counts, after one warm-up call that also applies the configuration*/
+#define TUNE_REPEATS 3
+
+/*tuned iparm entries, in database record order*/
+static const int tuned[5] = { 1, 4, 5, 6, 7 };
+
+/*
+* TuneParm: one searched iparm entry with its candidate values
+* Refactor entries are timed by GpuRefactorize, solve entries by GpuSolve
+*/
+struct TuneParm
+{
+    int index;
+    bool solve;
+    std::vector<int> values;
+};
+
+/*host: bulk threshold and #refactor threads, host solves have no launch parameters*/
+static std::vector<TuneParm> HostCandidates(int threads)
+{
+    std::vector<TuneParm> parms(2);
+    parms[0].index = 1;
+    parms[0].solve = false;
+    const int thresholds[] = { 1, 8, 32, 128, 512, INT_MAX };
+    parms[0].values.assign(thresholds, thresholds + sizeof(thresholds) / sizeof(thresholds[0]));
+    parms[1].index = 5;
+    parms[1].solve = false;
+    for (int t = 1; t < threads; t *= 2) parms[1].values.push_back(t);
+    parms[1].values.push_back(threads);
+    return parms;
+}
+
+/*GPU: bulk threshold, blocks per multiprocessor and threads per block of refactor and solve, 0 being the automatic decision*/
+static std::vector<TuneParm> GpuCandidates()
+{
+    const int thresholds[] = { 32, 64, 128, 256, 512 };
+    const int blocks[] = { 0, 1, 2, 4, 8 };
+    const int threads[] = { 0, 32, 64, 128, 256, 512 };
+    std::vector<TuneParm> parms(5);
+    for (int i = 0; i < 5; ++i)
+    {
+        parms[i].index = tuned[i];
+        parms[i].solve = tuned[i] >= 6;
+    }
+    parms[0].values.assign(thresholds, thresholds + sizeof(thresholds) / sizeof(thresholds[0]));
+    parms[1].values.assign(blocks, blocks + sizeof(blocks) / sizeof(blocks[0]));
+    parms[2].values.assign(threads, threads + sizeof(threads) / sizeof(threads[0]));
+    parms[3].values = parms[1].values;
+    parms[4].values = parms[2].values;
+    return parms;
+}
+
+/*best time (in seconds) of TUNE_REPEATS calls of f, ret is the first nonzero return of f*/
+template <typename F>
+static double Time(F f, int &ret)
+{
+    ret = f();
+    double best = 1e300;
+    for (int r = 0; r < TUNE_REPEATS && 0 == ret; ++r)
+    {
+        const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        ret = f();
+        const double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        if (t < best) best = t;
+    }
+    return best;
+}
+
+/*
+* database: text file, one record per line
+* <n> <nnz> <pattern hash> <complex> <backend> <iparm[1]> <iparm[4]> <iparm[5]> <iparm[6]> <iparm[7]> <refactor us> <solve us>
+* lines starting with '#' are comments
+*/
+static std::string Key(long long n, long long nnz, unsigned long long hash, bool is_complex, bool host)
+{
+    char key[96];
+    snprintf(key, sizeof(key), "%lld %lld %016llx %d %s ", n, nnz, hash, is_complex ? 1 : 0, host ? "host" : "gpu");
+    return key;
+}
+
+static void ReadLines(const char db[], std::vector<std::string> &lines)
+{
+    FILE *fp = fopen(db, "r");
+    if (NULL == fp) return;
+    char buf[256];
+    while (fgets(buf, sizeof(buf), fp) != NULL)
+    {
+        size_t len = strlen(buf);
+        while (len > 0 && ('\n' == buf[len - 1] || '\r' == buf[len - 1])) buf[--len] = '\0';
+        if (len > 0) lines.push_back(buf);
+    }
+    fclose(fp);
+}
+
+static bool Lookup(const char db[], const std::string &key, int parm[5])
+{
+    std::vector<std::string> lines;
+    ReadLines(db, lines);
+    for (size_t i = lines.size(); i-- > 0;)
+    {
+        if (lines[i].compare(0, key.size(), key) != 0) continue;
+        if (sscanf(lines[i].c_str() + key.size(), "%d %d %d %d %d", parm, parm + 1, parm + 2, parm + 3, parm + 4) == 5) return true;
+    }
+    return false;
+}
+
+/*
+* DbLock: exclusive advisory lock on <db>.lock, held from reading the database to renaming the new one over it
+* The database itself cannot be locked, since each store replaces it
+*/
+class DbLock
+{
+public:
+    explicit DbLock(const char db[])
+    {
+        const std::string file = std::string(db) + ".lock";
+#ifdef _WIN32
+        handle_ = CreateFileA(file.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        OVERLAPPED o;
+        memset(&o, 0, sizeof(o));
+        locked_ = handle_ != INVALID_HANDLE_VALUE && LockFileEx(handle_, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &o);
+#else
+        fd_ = open(file.c_str(), O_RDWR | O_CREAT, 0666);
+        int ret = -1;
+        if (fd_ >= 0)
+        {
+            do ret = flock(fd_, LOCK_EX);
+            while (ret != 0 && EINTR == errno);
+        }
+        locked_ = (0 == ret);
+#endif
+    }
+    ~DbLock()
+    {
+#ifdef _WIN32
+        if (locked_)
+        {
+            OVERLAPPED o;
+            memset(&o, 0, sizeof(o));
+            UnlockFileEx(handle_, 0, 1, 0, &o);
+        }
+        if (handle_ != INVALID_HANDLE_VALUE) CloseHandle(handle_);
+#else
+        if (locked_) flock(fd_, LOCK_UN);
+        if (fd_ >= 0) close(fd_);
+#endif
+    }
+    bool Locked() const
+    {
+        return locked_;
+    }
+
+private:
+    DbLock(const DbLock &);
+    DbLock &operator=(const DbLock &);
+#ifdef _WIN32
+    HANDLE handle_;
+#else
+    int fd_;
+#endif
+    bool locked_;
+};
+
+/*
+* replaces the record of key, written to a private file and renamed
+* the records of other keys are read under the lock, so that concurrent stores, also by other processes, keep each other's records
+*/
+static bool Store(const char db[], const std::string &key, const int parm[5], double refactor, double solve)
+{
+    DbLock lock(db);
+    if (!lock.Locked()) return false;
+    std::vector<std::string> lines;
+    ReadLines(db, lines);
+    const std::string tmp = TempName(db);
+    FILE *fp = fopen(tmp.c_str(), "w");
+    if (NULL == fp) return false;
+    bool ok = fprintf(fp, "# CKTSO-GPU tuning database: n nnz hash complex backend iparm[1] iparm[4] iparm[5] iparm[6] iparm[7] refactor(us) solve(us)\n") > 0;
+    for (size_t i = 0; i < lines.size() && ok; ++i)
+    {
+        if ('#' == lines[i][0] || 0 == lines[i].compare(0, key.size(), key)) continue;
+        ok = fprintf(fp, "%s\n", lines[i].c_str()) > 0;
+    }
+    ok = ok && fprintf(fp, "%s%d %d %d %d %d %.0f %.0f\n", key.c_str(), parm[0], parm[1], parm[2], parm[3], parm[4], refactor * 1e6, solve * 1e6) > 0;
+    ok = (fclose(fp) == 0) && ok;
+#ifdef _WIN32
+    if (ok) remove(db);
+#endif
+    ok = ok && rename(tmp.c_str(), db) == 0;
+    if (!ok) remove(tmp.c_str());
+    return ok;
+}
+
+/*
+* coordinate search: each entry in turn takes its fastest candidate, the others keeping their best values so far,
+* a candidate is timed only when its expected cost still fits in the budget. The current iparm is the first configuration timed
+*/
+template <typename Accel, typename HostType, typename Index>
+static int Autotune(Accel *accel, int iparm[], bool is_complex, Index n, const Index ap[], const Index ai[], const double ax[],
+    int budget, const char db[], bool *found)
+{
+    if (NULL == accel) return -1;
+    if (NULL == iparm || n <= 0 || NULL == ap || NULL == ai || NULL == ax) return -2;
+    if (found != NULL) *found = false;
+    HostType *host = dynamic_cast<HostType *>(accel);
+    const std::string key = Key((long long)n, (long long)ap[n], PatternHash(n, ap, ai), is_complex, host != NULL);
+
+    int best[5];
+    if (db != NULL && Lookup(db, key, best))
+    {
+        for (int i = 0; i < 5; ++i) iparm[tuned[i]] = best[i];
+        if (found != NULL) *found = true;
+        return accel->GpuRefactorize(ax);
+    }
+    if (budget <= 0) return 0;
+
+    /*bypass would skip the timed refactors*/
+    const int bypass = host != NULL ? iparm[9] : 0;
+    if (host != NULL) iparm[9] = 0;
+    std::vector<TuneParm> parms = host != NULL ? HostCandidates(host->Threads(0)) : GpuCandidates();
+    std::vector<double> b, x;
+    try
+    {
+        b.assign((size_t)n * (is_complex ? 2 : 1), 1.);
+        x.resize(b.size());
+    }
+    catch (const std::bad_alloc &)
+    {
+        if (host != NULL) iparm[9] = bypass;
+        return -4;
+    }
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int ret = 0;
+    double refactor = Time([&]() { return accel->GpuRefactorize(ax); }, ret);
+    double solve = 0 == ret ? Time([&]() { return accel->GpuSolve(&b[0], &x[0], false); }, ret) : 0.;
+    for (size_t p = 0; p < parms.size() && 0 == ret; ++p)
+    {
+        const TuneParm &parm = parms[p];
+        const int current = iparm[parm.index];
+        int choice = current;
+        for (size_t v = 0; v < parm.values.size() && 0 == ret; ++v)
+        {
+            if (parm.values[v] == current) continue;
+            const double cost = (TUNE_REPEATS + 1) * (parm.solve ? refactor + solve : refactor);
+            if ((std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() + cost) * 1e3 > budget) break;
+            iparm[parm.index] = parm.values[v];
+            if (parm.solve)
+            {
+                /*solve parameters may be read at refactor*/
+                ret = accel->GpuRefactorize(ax);
+                const double t = 0 == ret ? Time([&]() { return accel->GpuSolve(&b[0], &x[0], false); }, ret) : 0.;
+                if (0 == ret && t < solve)
+                {
+                    solve = t;
+                    choice = parm.values[v];
+                }
+            }
+            else
+            {
+                const double t = Time([&]() { return accel->GpuRefactorize(ax); }, ret);
+                if (0 == ret && t < refactor)
+                {
+                    refactor = t;
+                    choice = parm.values[v];
+                }
+            }
+        }
+        iparm[parm.index] = choice;
+    }
+    if (host != NULL) iparm[9] = bypass;
+    if (ret != 0) return ret;
+
+    ret = accel->GpuRefactorize(ax);
+    if (ret != 0) return ret;
+    if (db != NULL)
+    {
+        for (int i = 0; i < 5; ++i) best[i] = iparm[tuned[i]];
+        if (!Store(db, key, best, refactor, solve)) return -56;
+    }
+    return 0;
+}
+
+}
+
+using namespace cktso_host;
+
+int CKTSO_GpuAutotune(ICktSoGpu accel, int iparm[], bool is_complex, int n, const int ap[], const int ai[], const double ax[],
+    int budget, const char db[], bool *found)
+{
+    return Autotune<__CKTSO_GPU, HostAccel, int>(accel, iparm, is_complex, n, ap, ai, ax, budget, db, found);
+}
+
+int CKTSO_L_GpuAutotune(ICktSoGpu_L accel, int iparm[], bool is_complex, long long n, const long long ap[], const long long ai[], const double ax[],
+    int budget, const char db[], bool *found)
+{
+    return Autotune<__CKTSO_L_GPU, HostAccel_L, long long>(accel, iparm, is_complex, n, ap, ai, ax, budget, db, found);
+}
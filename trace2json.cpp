@@ -0,0 +1,20 @@
+#include <stdio.h>
+#include "cktso-gpu-host.h"
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        printf("Usage: trace2json <binary trace> <json file>\n");
+        printf("    converts a trace written by CKTSO_GpuDumpTrace(..., binary = true, ...), the JSON file opens in chrome://tracing or Perfetto\n");
+        printf("Example: trace2json refactor.trc refactor.json\n");
+        return -1;
+    }
+    const int ret = CKTSO_ConvertTrace(argv[1], argv[2]);
+    if (ret != 0)
+    {
+        printf("Failed to convert \"%s\" to \"%s\", return code = %d.\n", argv[1], argv[2], ret);
+        return -1;
+    }
+    return 0;
+}